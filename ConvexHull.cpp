@@ -0,0 +1,316 @@
+//
+// ConvexHull.cpp
+//
+// Convex hull of a point cloud and the mass properties of the solid it encloses.
+//
+
+#include "ConvexHull.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include "ParallelFor.h"
+
+// Quickhull keeps, for every face of the current hull, the set of points that lie outside it.
+// Each step takes the farthest outside point of some face (the "eye"), deletes every face the
+// eye can see, and closes the hole with a fan of new faces from the horizon to the eye.  The
+// points owned by the deleted faces are handed to the new faces or, when they are now inside,
+// dropped.  The hull is done when no face has outside points left.
+//
+// Faces find their neighbors through a map from directed edge to face: the face across edge
+// (a, b) is the one that owns (b, a).
+
+// points sorted in chunks of this many so that each chunk can be handled by one thread
+const uint32_t POINTS_PER_CHUNK = 4096;
+
+struct HullFace {
+    uint32_t vertices[3];
+    btVector3 normal;
+    btScalar offset;            // normal.dot(point on plane)
+    VectorOfIndices outside;    // points in front of this face and not claimed by an earlier face
+    bool alive;
+
+    btScalar distance(const btVector3& point) const { return normal.dot(point) - offset; }
+};
+
+// helper function
+inline uint64_t edgeKey(uint32_t a, uint32_t b) {
+    return ((uint64_t)a << 32) | (uint64_t)b;
+}
+
+// helper function
+void initFace(const VectorOfPoints& points, uint32_t a, uint32_t b, uint32_t c, HullFace& face) {
+    face.vertices[0] = a;
+    face.vertices[1] = b;
+    face.vertices[2] = c;
+    face.normal = (points[b] - points[a]).cross(points[c] - points[a]);
+    btScalar length = face.normal.length();
+    if (length > 0.0f) {
+        face.normal /= length;
+    }
+    face.offset = face.normal.dot(points[a]);
+    face.outside.clear();
+    face.alive = true;
+}
+
+// helper function
+void assignOutsidePoints(const VectorOfPoints& points, const VectorOfIndices& candidates,
+        std::vector<HullFace>& faces, uint32_t firstFace, uint32_t endFace, btScalar tolerance, uint32_t numThreads) {
+    // Gives each candidate to the first face in [firstFace, endFace) that it is in front of.
+    // Chunks are sorted independently and merged in order so the result does not depend on
+    // the number of threads.
+    uint32_t numCandidates = candidates.size();
+    uint32_t numFaces = endFace - firstFace;
+    uint32_t numChunks = (numCandidates + POINTS_PER_CHUNK - 1) / POINTS_PER_CHUNK;
+    if (numChunks <= 1) {
+        for (uint32_t i = 0; i < numCandidates; ++i) {
+            uint32_t point = candidates[i];
+            for (uint32_t f = firstFace; f < endFace; ++f) {
+                if (faces[f].distance(points[point]) > tolerance) {
+                    faces[f].outside.push_back(point);
+                    break;
+                }
+            }
+        }
+        return;
+    }
+
+    std::vector<VectorOfIndices> chunkOutside(numChunks * numFaces);
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            uint32_t begin = chunk * POINTS_PER_CHUNK;
+            uint32_t end = (numCandidates - begin > POINTS_PER_CHUNK) ? begin + POINTS_PER_CHUNK : numCandidates;
+            VectorOfIndices* outside = &chunkOutside[chunk * numFaces];
+            for (uint32_t i = begin; i < end; ++i) {
+                uint32_t point = candidates[i];
+                for (uint32_t f = 0; f < numFaces; ++f) {
+                    if (faces[firstFace + f].distance(points[point]) > tolerance) {
+                        outside[f].push_back(point);
+                        break;
+                    }
+                }
+            }
+        }
+    }, numThreads);
+    for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+        for (uint32_t f = 0; f < numFaces; ++f) {
+            const VectorOfIndices& outside = chunkOutside[chunk * numFaces + f];
+            faces[firstFace + f].outside.insert(faces[firstFace + f].outside.end(), outside.begin(), outside.end());
+        }
+    }
+}
+
+// helper function
+bool findInitialSimplex(const VectorOfPoints& points, btScalar tolerance, uint32_t simplex[4]) {
+    // the two extreme points farthest apart along any axis, the point farthest from the line
+    // through them, then the point farthest from the plane through all three
+    uint32_t numPoints = points.size();
+    uint32_t minimum[3] = { 0, 0, 0 };
+    uint32_t maximum[3] = { 0, 0, 0 };
+    for (uint32_t i = 1; i < numPoints; ++i) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            if (points[i][k] < points[minimum[k]][k]) {
+                minimum[k] = i;
+            }
+            if (points[i][k] > points[maximum[k]][k]) {
+                maximum[k] = i;
+            }
+        }
+    }
+    btScalar maxSpan = -1.0f;
+    for (uint32_t k = 0; k < 3; ++k) {
+        btScalar span = points[maximum[k]][k] - points[minimum[k]][k];
+        if (span > maxSpan) {
+            maxSpan = span;
+            simplex[0] = minimum[k];
+            simplex[1] = maximum[k];
+        }
+    }
+    if (maxSpan <= tolerance) {
+        return false;
+    }
+
+    const btVector3& a = points[simplex[0]];
+    btVector3 axis = (points[simplex[1]] - a).normalized();
+    btScalar maxDistance = 0.0f;
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        btScalar distance = (points[i] - a).cross(axis).length();
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            simplex[2] = i;
+        }
+    }
+    if (maxDistance <= tolerance) {
+        return false;
+    }
+
+    btVector3 normal = (points[simplex[1]] - a).cross(points[simplex[2]] - a).normalized();
+    maxDistance = 0.0f;
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        btScalar distance = btFabs(normal.dot(points[i] - a));
+        if (distance > maxDistance) {
+            maxDistance = distance;
+            simplex[3] = i;
+        }
+    }
+    return maxDistance > tolerance;
+}
+
+bool computeConvexHullMassProperties(const VectorOfPoints& points, MeshMassProperties& result,
+        VectorOfIndices& hullTriangles, uint32_t numThreads) {
+    uint32_t numPoints = points.size();
+    if (numPoints < 4) {
+        return false;
+    }
+
+    // the tolerance scales with the extent of the cloud
+    btScalar extent = 0.0f;
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        extent = btMax(extent, btFabs(points[i][0]) + btFabs(points[i][1]) + btFabs(points[i][2]));
+    }
+    btScalar tolerance = 3.0f * extent * std::numeric_limits<btScalar>::epsilon();
+
+    uint32_t simplex[4];
+    if (!findInitialSimplex(points, tolerance, simplex)) {
+        return false;
+    }
+
+    // build the tetrahedron with its faces pointing away from its centroid
+    btVector3 interior = 0.25f * (points[simplex[0]] + points[simplex[1]] + points[simplex[2]] + points[simplex[3]]);
+    std::vector<HullFace> faces(4);
+    std::unordered_map<uint64_t, uint32_t> edgeToFace;
+    const uint32_t TETRAHEDRON[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } };
+    bool flip = false;
+    for (uint32_t f = 0; f < 4; ++f) {
+        uint32_t a = simplex[TETRAHEDRON[f][0]];
+        uint32_t b = simplex[TETRAHEDRON[f][1]];
+        uint32_t c = simplex[TETRAHEDRON[f][2]];
+        if (f == 0) {
+            HullFace probe;
+            initFace(points, a, b, c, probe);
+            flip = probe.distance(interior) > 0.0f;
+        }
+        if (flip) {
+            std::swap(b, c);
+        }
+        initFace(points, a, b, c, faces[f]);
+        edgeToFace[edgeKey(a, b)] = f;
+        edgeToFace[edgeKey(b, c)] = f;
+        edgeToFace[edgeKey(c, a)] = f;
+    }
+
+    VectorOfIndices candidates;
+    candidates.reserve(numPoints);
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        if (i != simplex[0] && i != simplex[1] && i != simplex[2] && i != simplex[3]) {
+            candidates.push_back(i);
+        }
+    }
+    assignOutsidePoints(points, candidates, faces, 0, 4, tolerance, numThreads);
+
+    VectorOfIndices pending = { 0, 1, 2, 3 };
+    VectorOfIndices visible;
+    std::vector<uint64_t> horizon;
+    while (!pending.empty()) {
+        uint32_t start = pending.back();
+        pending.pop_back();
+        if (!faces[start].alive || faces[start].outside.empty()) {
+            continue;
+        }
+
+        // the farthest outside point becomes the eye
+        uint32_t eye = faces[start].outside[0];
+        btScalar maxDistance = faces[start].distance(points[eye]);
+        for (uint32_t point : faces[start].outside) {
+            btScalar distance = faces[start].distance(points[point]);
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                eye = point;
+            }
+        }
+
+        // flood out from the start face to every face the eye can see, noting the horizon:
+        // edges of visible faces whose neighbor is not visible
+        visible.clear();
+        horizon.clear();
+        visible.push_back(start);
+        faces[start].alive = false;
+        for (uint32_t v = 0; v < visible.size(); ++v) {
+            const HullFace& face = faces[visible[v]];
+            for (uint32_t k = 0; k < 3; ++k) {
+                uint32_t a = face.vertices[k];
+                uint32_t b = face.vertices[(k + 1) % 3];
+                auto twin = edgeToFace.find(edgeKey(b, a));
+                assert(twin != edgeToFace.end());
+                uint32_t neighbor = twin->second;
+                if (!faces[neighbor].alive) {
+                    // already known to be visible
+                    continue;
+                }
+                if (faces[neighbor].distance(points[eye]) > tolerance) {
+                    faces[neighbor].alive = false;
+                    visible.push_back(neighbor);
+                } else {
+                    horizon.push_back(edgeKey(a, b));
+                }
+            }
+        }
+
+        // retire the visible faces and gather their orphaned points
+        candidates.clear();
+        for (uint32_t f : visible) {
+            HullFace& face = faces[f];
+            for (uint32_t k = 0; k < 3; ++k) {
+                edgeToFace.erase(edgeKey(face.vertices[k], face.vertices[(k + 1) % 3]));
+            }
+            for (uint32_t point : face.outside) {
+                if (point != eye) {
+                    candidates.push_back(point);
+                }
+            }
+            VectorOfIndices().swap(face.outside);
+        }
+
+        // fan new faces from the horizon to the eye
+        uint32_t firstNewFace = faces.size();
+        for (uint64_t edge : horizon) {
+            uint32_t a = (uint32_t)(edge >> 32);
+            uint32_t b = (uint32_t)edge;
+            uint32_t f = faces.size();
+            faces.push_back(HullFace());
+            initFace(points, a, b, eye, faces[f]);
+            edgeToFace[edgeKey(a, b)] = f;
+            edgeToFace[edgeKey(b, eye)] = f;
+            edgeToFace[edgeKey(eye, a)] = f;
+        }
+        uint32_t endNewFace = faces.size();
+        assignOutsidePoints(points, candidates, faces, firstNewFace, endNewFace, tolerance, numThreads);
+        for (uint32_t f = firstNewFace; f < endNewFace; ++f) {
+            if (!faces[f].outside.empty()) {
+                pending.push_back(f);
+            }
+        }
+    }
+
+    // Integrate over the finished hull.  A face can be deleted right up until the last step,
+    // so this happens once at the end.  The tetrahedra are formed with an interior point
+    // rather than the origin so that every one is positive.
+    hullTriangles.clear();
+    MassPropertiesAccumulator totals;
+    for (const HullFace& face : faces) {
+        if (face.alive) {
+            const uint32_t* v = face.vertices;
+            hullTriangles.push_back(v[0]);
+            hullTriangles.push_back(v[1]);
+            hullTriangles.push_back(v[2]);
+            totals.addTriangle(points[v[0]] - interior, points[v[1]] - interior, points[v[2]] - interior);
+        }
+    }
+    totals.getMassProperties(result);
+    result.m_centerOfMass += interior;
+    return true;
+}
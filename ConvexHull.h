@@ -0,0 +1,21 @@
+//
+//  ConvexHull.h
+//
+// Convex hull of a point cloud and the mass properties of the solid it encloses.
+
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+#include "MeshMassProperties.h"
+
+// Builds the convex hull of the points with quickhull and computes the mass properties of the
+// solid it encloses, e.g. for a btConvexHullShape.  On return hullTriangles holds the
+// right-hand wound hull triangles as indices into points.  Points within a small tolerance of
+// the hull (relative to the extent of the cloud) are treated as inside.  The work of sorting
+// the points into the outside sets of faces is split across numThreads threads (0 = one per
+// hardware core).  Returns false, leaving result untouched, when the points do not span a
+// volume (fewer than four, or all on one plane).
+bool computeConvexHullMassProperties(const VectorOfPoints& points, MeshMassProperties& result,
+        VectorOfIndices& hullTriangles, uint32_t numThreads = 0);
+
+#endif // CONVEX_HULL_H
@@ -0,0 +1,626 @@
+//
+// GltfMeshLoader.cpp
+//
+// Computes mass properties of the meshes in glTF 2.0 (.gltf + .bin, or .glb) files.
+//
+
+#include "GltfMeshLoader.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "MappedFile.h"
+
+// ---------------------------------------------------------------------------
+// Just enough JSON to read a glTF document.
+
+struct JsonValue {
+    enum Type { NONE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+    Type type = NONE;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue& operator[](const std::string& key) const {
+        static const JsonValue none;
+        for (const std::pair<std::string, JsonValue>& member : members) {
+            if (member.first == key) {
+                return member.second;
+            }
+        }
+        return none;
+    }
+    const JsonValue& operator[](size_t index) const {
+        static const JsonValue none;
+        return index < elements.size() ? elements[index] : none;
+    }
+    bool isNumber() const { return type == NUMBER; }
+    double asNumber(double defaultValue) const { return type == NUMBER ? number : defaultValue; }
+    // an array index, or one past any array when missing or negative
+    size_t asIndex() const { return (type == NUMBER && number >= 0.0 && number < 4294967296.0) ? (size_t)number : (size_t)-1; }
+    size_t size() const { return elements.size(); }
+};
+
+class JsonParser {
+public:
+    JsonParser(const char* begin, const char* end) : m_cursor(begin), m_end(end) {}
+
+    bool parse(JsonValue& value) {
+        return parseValue(value, 0) && (skipSpaces(), m_cursor == m_end);
+    }
+
+private:
+    void skipSpaces() {
+        while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\n' || *m_cursor == '\r')) {
+            ++m_cursor;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpaces();
+        if (m_cursor < m_end && *m_cursor == c) {
+            ++m_cursor;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseString(std::string& text) {
+        if (!consume('"')) {
+            return false;
+        }
+        while (m_cursor < m_end && *m_cursor != '"') {
+            char c = *m_cursor++;
+            if (c == '\\') {
+                if (m_cursor >= m_end) {
+                    return false;
+                }
+                c = *m_cursor++;
+                switch (c) {
+                    case 'n': c = '\n'; break;
+                    case 't': c = '\t'; break;
+                    case 'r': c = '\r'; break;
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'u': {
+                        // names only matter for reporting, so non-ASCII code points become '?'
+                        if (m_end - m_cursor < 4) {
+                            return false;
+                        }
+                        unsigned code = (unsigned)strtoul(std::string(m_cursor, m_cursor + 4).c_str(), nullptr, 16);
+                        m_cursor += 4;
+                        c = code < 0x80 ? (char)code : '?';
+                        break;
+                    }
+                    default: break;
+                }
+            }
+            text += c;
+        }
+        return consume('"');
+    }
+
+    bool parseValue(JsonValue& value, int depth) {
+        const int MAX_DEPTH = 64;
+        skipSpaces();
+        if (m_cursor >= m_end || depth > MAX_DEPTH) {
+            return false;
+        }
+        char c = *m_cursor;
+        if (c == '{') {
+            ++m_cursor;
+            value.type = JsonValue::OBJECT;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                std::pair<std::string, JsonValue> member;
+                if (!parseString(member.first) || !consume(':') || !parseValue(member.second, depth + 1)) {
+                    return false;
+                }
+                value.members.push_back(std::move(member));
+            } while (consume(','));
+            return consume('}');
+        }
+        if (c == '[') {
+            ++m_cursor;
+            value.type = JsonValue::ARRAY;
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                value.elements.push_back(JsonValue());
+                if (!parseValue(value.elements.back(), depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+        if (c == '"') {
+            value.type = JsonValue::STRING;
+            return parseString(value.text);
+        }
+        if (m_end - m_cursor >= 4 && strncmp(m_cursor, "true", 4) == 0) {
+            m_cursor += 4;
+            value.type = JsonValue::BOOLEAN;
+            value.boolean = true;
+            return true;
+        }
+        if (m_end - m_cursor >= 5 && strncmp(m_cursor, "false", 5) == 0) {
+            m_cursor += 5;
+            value.type = JsonValue::BOOLEAN;
+            return true;
+        }
+        if (m_end - m_cursor >= 4 && strncmp(m_cursor, "null", 4) == 0) {
+            m_cursor += 4;
+            return true;
+        }
+        // number: copy the token so strtod cannot run past the end of the buffer
+        const char* start = m_cursor;
+        while (m_cursor < m_end && strchr("+-0123456789.eE", *m_cursor)) {
+            ++m_cursor;
+        }
+        if (m_cursor == start) {
+            return false;
+        }
+        value.type = JsonValue::NUMBER;
+        value.number = strtod(std::string(start, m_cursor).c_str(), nullptr);
+        return true;
+    }
+
+    const char* m_cursor;
+    const char* m_end;
+};
+
+// ---------------------------------------------------------------------------
+
+const uint32_t GLB_MAGIC = 0x46546c67;       // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;  // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004e4942;   // "BIN\0"
+
+const int GLTF_UNSIGNED_BYTE = 5121;
+const int GLTF_UNSIGNED_SHORT = 5123;
+const int GLTF_UNSIGNED_INT = 5125;
+const int GLTF_FLOAT = 5126;
+
+const int GLTF_MODE_TRIANGLES = 4;
+const int GLTF_MODE_TRIANGLE_STRIP = 5;
+const int GLTF_MODE_TRIANGLE_FAN = 6;
+
+struct GltfBuffer {
+    const char* data = nullptr;
+    size_t size = 0;
+};
+
+// A typed, strided view of an accessor's elements inside a mapped buffer.  A null data pointer
+// stands for an accessor without a bufferView, whose elements are all zero.
+struct GltfAccessorView {
+    const char* data = nullptr;
+    uint32_t count = 0;
+    uint32_t stride = 0;
+    int componentType = 0;
+};
+
+// helper function
+uint32_t readLittleEndian32(const char* data) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+// helper function
+bool decodeBase64(const char* text, size_t length, std::vector<char>& bytes) {
+    uint32_t accumulator = 0;
+    int numBits = 0;
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '+') value = 62;
+        else if (c == '/') value = 63;
+        else if (c == '=') break;
+        else return false;
+        accumulator = (accumulator << 6) | value;
+        numBits += 6;
+        if (numBits >= 8) {
+            numBits -= 8;
+            bytes.push_back((char)((accumulator >> numBits) & 0xff));
+        }
+    }
+    return true;
+}
+
+// helper function
+bool readGltfSize(const JsonValue& value, uint64_t defaultValue, uint64_t& size) {
+    // counts, offsets and lengths must be non-negative integers small enough to convert exactly
+    if (value.type == JsonValue::NONE) {
+        size = defaultValue;
+        return true;
+    }
+    if (value.type != JsonValue::NUMBER || !(value.number >= 0.0) || value.number >= 9007199254740992.0
+            || value.number != floor(value.number)) {
+        return false;
+    }
+    size = (uint64_t)value.number;
+    return true;
+}
+
+// helper function
+bool getAccessorView(const JsonValue& document, const std::vector<GltfBuffer>& buffers, size_t accessorIndex,
+        uint32_t numComponents, GltfAccessorView& view, std::string& error) {
+    const JsonValue& accessor = document["accessors"][accessorIndex];
+    if (accessor.type != JsonValue::OBJECT) {
+        error = "missing accessor";
+        return false;
+    }
+    if (accessor["sparse"].type != JsonValue::NONE) {
+        error = "sparse accessors are not supported";
+        return false;
+    }
+    uint64_t componentType = 0, count = 0;
+    if (!readGltfSize(accessor["componentType"], 0, componentType) || !readGltfSize(accessor["count"], 0, count)
+            || count > UINT32_MAX) {
+        error = "accessor has an invalid componentType or count";
+        return false;
+    }
+    view.componentType = (int)std::min<uint64_t>(componentType, INT32_MAX);
+    view.count = (uint32_t)count;
+    if (accessor["bufferView"].type == JsonValue::NONE) {
+        // the spec says an accessor without a bufferView reads as zeros
+        view.data = nullptr;
+        view.stride = 0;
+        return true;
+    }
+    const JsonValue& bufferView = document["bufferViews"][accessor["bufferView"].asIndex()];
+    if (bufferView.type != JsonValue::OBJECT) {
+        error = "accessor references a missing bufferView";
+        return false;
+    }
+    size_t bufferIndex = bufferView["buffer"].asIndex();
+    if (bufferIndex >= buffers.size()) {
+        error = "missing buffer";
+        return false;
+    }
+    const GltfBuffer& buffer = buffers[bufferIndex];
+    uint32_t componentSize = (view.componentType == GLTF_UNSIGNED_BYTE) ? 1 : (view.componentType == GLTF_UNSIGNED_SHORT) ? 2 : 4;
+    uint32_t elementSize = componentSize * numComponents;
+    uint64_t viewOffset = 0, viewLength = 0, accessorOffset = 0, stride = 0;
+    if (!readGltfSize(bufferView["byteOffset"], 0, viewOffset) || !readGltfSize(bufferView["byteLength"], 0, viewLength)
+            || !readGltfSize(accessor["byteOffset"], 0, accessorOffset)
+            || !readGltfSize(bufferView["byteStride"], elementSize, stride)) {
+        error = "bufferView or accessor has an invalid byteOffset, byteLength or byteStride";
+        return false;
+    }
+    if (bufferView["byteStride"].type != JsonValue::NONE && (stride < elementSize || stride > 252 || stride % 4 != 0)) {
+        error = "byteStride must be a multiple of 4 between the element size and 252";
+        return false;
+    }
+    // each comparison subtracts only what the previous ones proved to fit, so nothing can wrap
+    if (viewLength > buffer.size || viewOffset > buffer.size - viewLength) {
+        error = "bufferView runs past the end of its buffer";
+        return false;
+    }
+    if (view.count > 0 && (elementSize > viewLength || accessorOffset > viewLength - elementSize
+            || view.count - 1 > (viewLength - accessorOffset - elementSize) / stride)) {
+        error = "accessor runs past the end of its bufferView";
+        return false;
+    }
+    view.stride = (uint32_t)stride;
+    view.data = buffer.data + viewOffset + accessorOffset;
+    return true;
+}
+
+// helper function
+inline uint32_t readGltfIndex(const GltfAccessorView& indices, uint32_t i) {
+    if (!indices.data) {
+        return 0;
+    }
+    const char* element = indices.data + (size_t)i * indices.stride;
+    switch (indices.componentType) {
+        case GLTF_UNSIGNED_BYTE: return (uint8_t)element[0];
+        case GLTF_UNSIGNED_SHORT: { uint16_t v; memcpy(&v, element, 2); return v; }
+        default: { uint32_t v; memcpy(&v, element, 4); return v; }
+    }
+}
+
+// helper function
+inline btVector3 readGltfPosition(const GltfAccessorView& positions, uint32_t i) {
+    if (!positions.data) {
+        return btVector3(0.0f, 0.0f, 0.0f);
+    }
+    float xyz[3];
+    memcpy(xyz, positions.data + (size_t)i * positions.stride, sizeof(xyz));
+    return btVector3(xyz[0], xyz[1], xyz[2]);
+}
+
+// helper function
+bool accumulateGltfPrimitive(const JsonValue& document, const std::vector<GltfBuffer>& buffers, const JsonValue& primitive,
+        MassPropertiesAccumulator& totals, uint32_t& numTriangles, std::string& error) {
+    int mode = (int)primitive["mode"].asNumber(GLTF_MODE_TRIANGLES);
+    if (mode != GLTF_MODE_TRIANGLES && mode != GLTF_MODE_TRIANGLE_STRIP && mode != GLTF_MODE_TRIANGLE_FAN) {
+        return true;
+    }
+    GltfAccessorView positions;
+    if (!getAccessorView(document, buffers, primitive["attributes"]["POSITION"].asIndex(), 3, positions, error)) {
+        return false;
+    }
+    if (positions.componentType != GLTF_FLOAT) {
+        error = "only float POSITION accessors are supported";
+        return false;
+    }
+    GltfAccessorView indices;
+    bool isIndexed = primitive["indices"].isNumber();
+    if (isIndexed && !getAccessorView(document, buffers, primitive["indices"].asIndex(), 1, indices, error)) {
+        return false;
+    }
+    uint32_t numCorners = isIndexed ? indices.count : positions.count;
+
+    // gather by index, or take vertices in order for non-indexed primitives
+    auto corner = [&](uint32_t i, uint32_t& vertex) {
+        vertex = isIndexed ? readGltfIndex(indices, i) : i;
+        return vertex < positions.count;
+    };
+    uint32_t v[3];
+    if (mode == GLTF_MODE_TRIANGLES) {
+        for (uint32_t i = 0; i + 2 < numCorners; i += 3) {
+            if (!corner(i, v[0]) || !corner(i + 1, v[1]) || !corner(i + 2, v[2])) {
+                error = "index out of range";
+                return false;
+            }
+            totals.addTriangle(readGltfPosition(positions, v[0]), readGltfPosition(positions, v[1]), readGltfPosition(positions, v[2]));
+            ++numTriangles;
+        }
+    } else {
+        // strips alternate winding; fans pivot about the first vertex
+        for (uint32_t i = 2; i < numCorners; ++i) {
+            uint32_t first = (mode == GLTF_MODE_TRIANGLE_FAN) ? 0 : i - 2;
+            if (!corner(first, v[0]) || !corner(i - 1, v[1]) || !corner(i, v[2])) {
+                error = "index out of range";
+                return false;
+            }
+            if (mode == GLTF_MODE_TRIANGLE_STRIP && (i & 1)) {
+                std::swap(v[0], v[1]);
+            }
+            totals.addTriangle(readGltfPosition(positions, v[0]), readGltfPosition(positions, v[1]), readGltfPosition(positions, v[2]));
+            ++numTriangles;
+        }
+    }
+    return true;
+}
+
+// helper function
+void getGltfNodeTransform(const JsonValue& node, btMatrix3x3& linear, btVector3& translation) {
+    // glTF matrices are column-major 4x4
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.size() == 16) {
+        for (int row = 0; row < 3; ++row) {
+            for (int column = 0; column < 3; ++column) {
+                linear[row][column] = (btScalar)matrix[4 * column + row].asNumber(0.0);
+            }
+            translation[row] = (btScalar)matrix[12 + row].asNumber(0.0);
+        }
+        return;
+    }
+
+    // otherwise T * R * S
+    const JsonValue& t = node["translation"];
+    const JsonValue& r = node["rotation"];
+    const JsonValue& s = node["scale"];
+    translation.setValue((btScalar)t[0].asNumber(0.0), (btScalar)t[1].asNumber(0.0), (btScalar)t[2].asNumber(0.0));
+    btScalar x = (btScalar)r[0].asNumber(0.0);
+    btScalar y = (btScalar)r[1].asNumber(0.0);
+    btScalar z = (btScalar)r[2].asNumber(0.0);
+    btScalar w = (btScalar)r[3].asNumber(1.0);
+    btMatrix3x3 rotation(
+        1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y - z * w), 2.0f * (x * z + y * w),
+        2.0f * (x * y + z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z - x * w),
+        2.0f * (x * z - y * w), 2.0f * (y * z + x * w), 1.0f - 2.0f * (x * x + y * y));
+    btVector3 scale((btScalar)s[0].asNumber(1.0), (btScalar)s[1].asNumber(1.0), (btScalar)s[2].asNumber(1.0));
+    linear = rotation.scaled(scale);
+}
+
+bool computeGltfMassProperties(const std::string& path, std::vector<GltfMeshInstance>& instances, std::string& error) {
+    instances.clear();
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open file";
+        return false;
+    }
+
+    // split GLB into its JSON and BIN chunks
+    const char* json = file.data();
+    size_t jsonSize = file.size();
+    GltfBuffer glbBuffer;
+    if (file.size() >= 12 && readLittleEndian32(file.data()) == GLB_MAGIC) {
+        size_t offset = 12;
+        json = nullptr;
+        while (offset + 8 <= file.size()) {
+            uint32_t chunkSize = readLittleEndian32(file.data() + offset);
+            uint32_t chunkType = readLittleEndian32(file.data() + offset + 4);
+            offset += 8;
+            if (offset + chunkSize > file.size()) {
+                break;
+            }
+            if (chunkType == GLB_CHUNK_JSON && !json) {
+                json = file.data() + offset;
+                jsonSize = chunkSize;
+            } else if (chunkType == GLB_CHUNK_BIN && !glbBuffer.data) {
+                glbBuffer.data = file.data() + offset;
+                glbBuffer.size = chunkSize;
+            }
+            offset += chunkSize;
+        }
+        if (!json) {
+            error = "GLB without JSON chunk";
+            return false;
+        }
+    }
+
+    JsonValue document;
+    if (!JsonParser(json, json + jsonSize).parse(document) || document.type != JsonValue::OBJECT) {
+        error = "malformed JSON";
+        return false;
+    }
+
+    // resolve buffers: GLB chunk, external files, or base64 data URIs
+    std::string directory;
+    size_t slash = path.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        directory = path.substr(0, slash + 1);
+    }
+    const JsonValue& bufferList = document["buffers"];
+    std::vector<GltfBuffer> buffers(bufferList.size());
+    std::vector<std::unique_ptr<MappedFile>> externalFiles;
+    std::vector<std::vector<char>> decodedBuffers;
+    decodedBuffers.reserve(bufferList.size());
+    for (size_t i = 0; i < bufferList.size(); ++i) {
+        const JsonValue& uri = bufferList[i]["uri"];
+        if (uri.type != JsonValue::STRING) {
+            buffers[i] = glbBuffer;
+        } else if (uri.text.compare(0, 5, "data:") == 0) {
+            size_t comma = uri.text.find(',');
+            decodedBuffers.push_back(std::vector<char>());
+            if (comma == std::string::npos || uri.text.find(";base64") > comma
+                    || !decodeBase64(uri.text.data() + comma + 1, uri.text.size() - comma - 1, decodedBuffers.back())) {
+                error = "unsupported data URI";
+                return false;
+            }
+            buffers[i].data = decodedBuffers.back().data();
+            buffers[i].size = decodedBuffers.back().size();
+        } else {
+            externalFiles.push_back(std::unique_ptr<MappedFile>(new MappedFile()));
+            if (!externalFiles.back()->open(directory + uri.text)) {
+                error = "cannot open buffer " + uri.text;
+                return false;
+            }
+            buffers[i].data = externalFiles.back()->data();
+            buffers[i].size = externalFiles.back()->size();
+        }
+    }
+
+    // each mesh is integrated once, in its own frame, the first time a node uses it
+    const JsonValue& meshes = document["meshes"];
+    std::vector<MeshMassProperties> meshProperties(meshes.size());
+    std::vector<uint32_t> meshTriangles(meshes.size(), 0);
+    std::vector<uint8_t> meshDone(meshes.size(), 0);
+    auto computeMesh = [&](size_t meshIndex) {
+        if (!meshDone[meshIndex]) {
+            MassPropertiesAccumulator totals;
+            const JsonValue& primitives = meshes[meshIndex]["primitives"];
+            for (size_t p = 0; p < primitives.size(); ++p) {
+                if (!accumulateGltfPrimitive(document, buffers, primitives[p], totals, meshTriangles[meshIndex], error)) {
+                    return false;
+                }
+            }
+            totals.getMassProperties(meshProperties[meshIndex]);
+            meshDone[meshIndex] = 1;
+        }
+        return true;
+    };
+
+    // walk the node hierarchy of the default scene, accumulating transforms
+    struct PendingNode {
+        size_t index;
+        btMatrix3x3 linear;
+        btVector3 translation;
+    };
+    const JsonValue& nodes = document["nodes"];
+    std::vector<size_t> roots;
+    const JsonValue& scenes = document["scenes"];
+    if (scenes.size() > 0) {
+        const JsonValue& sceneRoots = scenes[document["scene"].isNumber() ? document["scene"].asIndex() : 0]["nodes"];
+        for (size_t i = 0; i < sceneRoots.size(); ++i) {
+            roots.push_back(sceneRoots[i].asIndex());
+        }
+    } else if (nodes.size() > 0) {
+        // without scenes every node that is no other node's child is a root
+        std::vector<uint8_t> isChild(nodes.size(), 0);
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const JsonValue& children = nodes[i]["children"];
+            for (size_t j = 0; j < children.size(); ++j) {
+                size_t child = children[j].asIndex();
+                if (child < nodes.size()) {
+                    isChild[child] = 1;
+                }
+            }
+        }
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (!isChild[i]) {
+                roots.push_back(i);
+            }
+        }
+    } else {
+        // a document with meshes alone places each one once, untransformed
+        for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
+            if (!computeMesh(meshIndex)) {
+                return false;
+            }
+            GltfMeshInstance instance;
+            instance.name = meshes[meshIndex]["name"].text;
+            instance.meshIndex = meshIndex;
+            instance.numTriangles = meshTriangles[meshIndex];
+            instance.properties = meshProperties[meshIndex];
+            instances.push_back(instance);
+        }
+        return true;
+    }
+    std::vector<PendingNode> stack;
+    for (size_t root : roots) {
+        PendingNode pending;
+        pending.index = root;
+        pending.linear.setIdentity();
+        pending.translation.setZero();
+        stack.push_back(pending);
+    }
+    uint32_t numVisited = 0;
+    while (!stack.empty()) {
+        PendingNode pending = stack.back();
+        stack.pop_back();
+        const JsonValue& node = nodes[pending.index];
+        if (node.type != JsonValue::OBJECT || ++numVisited > nodes.size()) {
+            error = "bad node hierarchy";
+            return false;
+        }
+        btMatrix3x3 localLinear;
+        btVector3 localTranslation;
+        getGltfNodeTransform(node, localLinear, localTranslation);
+        btMatrix3x3 linear = pending.linear * localLinear;
+        btVector3 translation = pending.linear * localTranslation + pending.translation;
+
+        if (node["mesh"].isNumber()) {
+            size_t meshIndex = node["mesh"].asIndex();
+            if (meshIndex >= meshes.size()) {
+                error = "node references a missing mesh";
+                return false;
+            }
+            if (!computeMesh(meshIndex)) {
+                return false;
+            }
+            GltfMeshInstance instance;
+            instance.name = node["name"].type == JsonValue::STRING ? node["name"].text : meshes[meshIndex]["name"].text;
+            instance.meshIndex = meshIndex;
+            instance.numTriangles = meshTriangles[meshIndex];
+            instance.properties = meshProperties[meshIndex];
+            transformMassProperties(instance.properties, linear, translation);
+            instances.push_back(instance);
+        }
+
+        const JsonValue& children = node["children"];
+        for (size_t i = 0; i < children.size(); ++i) {
+            PendingNode child;
+            child.index = children[i].asIndex();
+            child.linear = linear;
+            child.translation = translation;
+            stack.push_back(child);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+//
+//  GltfMeshLoader.h
+//
+// Computes mass properties of the meshes in glTF 2.0 (.gltf + .bin, or .glb) files.
+
+#ifndef GLTF_MESH_LOADER_H
+#define GLTF_MESH_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include "MeshMassProperties.h"
+
+// One placement of a mesh in the scene, with its mass properties in scene coordinates.
+struct GltfMeshInstance {
+    std::string name;           // node name, or mesh name when the node has none
+    uint32_t meshIndex = 0;
+    uint32_t numTriangles = 0;
+    MeshMassProperties properties;
+};
+
+// Reads the default scene and returns one GltfMeshInstance per node that references a mesh.
+// A document without scenes is read as one scene of all its root nodes, and one without nodes
+// as a single untransformed instance of each mesh.  Accessors without a bufferView read as
+// zeros, as the spec requires.
+// Buffers are mapped and POSITION and index accessors (uint8, uint16, or uint32, honoring
+// byteStride) are read in place.  Each mesh is integrated once in its own frame and every
+// instance is then placed with transformMassProperties(), so vertices are never transformed.
+// Triangle list, strip, and fan primitives are integrated; point and line primitives carry no
+// volume and are skipped.  Returns false (with a reason in 'error') on unsupported input,
+// e.g. sparse or non-float position accessors.
+bool computeGltfMassProperties(const std::string& path, std::vector<GltfMeshInstance>& instances, std::string& error);
+
+#endif // GLTF_MESH_LOADER_H
@@ -0,0 +1,75 @@
+//
+// MappedFile.cpp
+//
+// Read-only view of a whole file, memory mapped where the platform allows it.
+//
+
+#include "MappedFile.h"
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    m_size = (size_t)info.st_size;
+    if (m_size > 0) {
+        void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            // the readers scan front to back
+            madvise(address, m_size, MADV_SEQUENTIAL);
+            m_data = (const char*)address;
+            m_isMapped = true;
+            ::close(fd);
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    // fall back to reading the whole file
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    m_buffer.resize(size > 0 ? size : 0);
+    bool ok = m_buffer.empty() || fread(m_buffer.data(), 1, m_buffer.size(), file) == m_buffer.size();
+    fclose(file);
+    if (!ok) {
+        m_buffer.clear();
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (m_isMapped) {
+        munmap((void*)m_data, m_size);
+    }
+#endif
+    m_isMapped = false;
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.clear();
+}
@@ -0,0 +1,36 @@
+//
+//  MappedFile.h
+//
+// Read-only view of a whole file, memory mapped where the platform allows it.
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // returns false if the file cannot be opened or mapped
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_isMapped = false;
+    std::vector<char> m_buffer; // fallback when the file cannot be mapped
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,225 @@
+//
+// MassPropertiesCache.cpp
+//
+// Thread-safe cache of MeshMassProperties results keyed by the content of the mesh.
+//
+
+#include "MassPropertiesCache.h"
+
+#include <string.h>
+
+// The hash follows the structure of XXH64: four independent accumulator lanes consume 64-bit
+// words round-robin (so the compiler can keep them in separate registers) and are merged at the end.
+
+const uint64_t HASH_PRIME_1 = 0x9e3779b185ebca87ULL;
+const uint64_t HASH_PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+const uint64_t HASH_PRIME_3 = 0x165667b19e3779f9ULL;
+const uint64_t HASH_PRIME_4 = 0x85ebca77c2b2ae63ULL;
+
+// helper function
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// helper function
+inline uint64_t hashRound(uint64_t accumulator, uint64_t word) {
+    accumulator += word * HASH_PRIME_2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * HASH_PRIME_1;
+}
+
+class ContentHasher {
+public:
+    ContentHasher(uint64_t seed) {
+        m_lanes[0] = seed + HASH_PRIME_1 + HASH_PRIME_2;
+        m_lanes[1] = seed + HASH_PRIME_2;
+        m_lanes[2] = seed;
+        m_lanes[3] = seed - HASH_PRIME_1;
+    }
+
+    void addWords(uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3) {
+        m_lanes[0] = hashRound(m_lanes[0], w0);
+        m_lanes[1] = hashRound(m_lanes[1], w1);
+        m_lanes[2] = hashRound(m_lanes[2], w2);
+        m_lanes[3] = hashRound(m_lanes[3], w3);
+        m_length += 32;
+    }
+
+    uint64_t finish() const {
+        uint64_t h = rotateLeft(m_lanes[0], 1) + rotateLeft(m_lanes[1], 7)
+            + rotateLeft(m_lanes[2], 12) + rotateLeft(m_lanes[3], 18);
+        for (int i = 0; i < 4; ++i) {
+            h ^= hashRound(0, m_lanes[i]);
+            h = h * HASH_PRIME_1 + HASH_PRIME_4;
+        }
+        h += m_length;
+        h ^= h >> 33;
+        h *= HASH_PRIME_2;
+        h ^= h >> 29;
+        h *= HASH_PRIME_3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    uint64_t m_lanes[4];
+    uint64_t m_length = 0;
+};
+
+// helper function
+inline uint64_t packScalars(const btScalar* values) {
+    // two scalars per word (btScalar is float unless Bullet is built with double precision,
+    // in which case the two are folded together)
+    uint64_t a = 0;
+    uint64_t b = 0;
+    memcpy(&a, values, sizeof(btScalar) < 8 ? sizeof(btScalar) : 8);
+    memcpy(&b, values + 1, sizeof(btScalar) < 8 ? sizeof(btScalar) : 8);
+    return (sizeof(btScalar) < 8) ? (a | (b << 32)) : (a ^ rotateLeft(b, 32));
+}
+
+// Feeds the same words to two differently seeded hashers, for a check hash in the same pass.
+class DualContentHasher {
+public:
+    DualContentHasher(uint64_t seed) : m_first(seed), m_second(seed ^ HASH_PRIME_3) {}
+
+    void addWords(uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3) {
+        m_first.addWords(w0, w1, w2, w3);
+        m_second.addWords(w0, w1, w2, w3);
+    }
+
+    const ContentHasher& getFirst() const { return m_first; }
+    const ContentHasher& getSecond() const { return m_second; }
+
+private:
+    ContentHasher m_first;
+    ContentHasher m_second;
+};
+
+// helper function
+template <typename Hasher>
+void addMeshContent(const VectorOfPoints& points, const VectorOfIndices& triangleIndices, Hasher& hasher) {
+
+    // points: two at a time, each as one word of (x, y) and one of (z, 0)
+    uint32_t numPoints = points.size();
+    uint32_t i = 0;
+    for (; i + 1 < numPoints; i += 2) {
+        const btScalar* p = points[i];
+        const btScalar* q = points[i + 1];
+        btScalar pz[2] = { p[2], 0.0f };
+        btScalar qz[2] = { q[2], 0.0f };
+        hasher.addWords(packScalars(p), packScalars(pz), packScalars(q), packScalars(qz));
+    }
+    if (i < numPoints) {
+        const btScalar* p = points[i];
+        btScalar pz[2] = { p[2], 0.0f };
+        hasher.addWords(packScalars(p), packScalars(pz), 0, 0);
+    }
+
+    // indices: eight at a time
+    uint32_t numIndices = triangleIndices.size();
+    const uint32_t* indices = triangleIndices.data();
+    uint32_t j = 0;
+    for (; j + 7 < numIndices; j += 8) {
+        hasher.addWords(
+            (uint64_t)indices[j] | ((uint64_t)indices[j + 1] << 32),
+            (uint64_t)indices[j + 2] | ((uint64_t)indices[j + 3] << 32),
+            (uint64_t)indices[j + 4] | ((uint64_t)indices[j + 5] << 32),
+            (uint64_t)indices[j + 6] | ((uint64_t)indices[j + 7] << 32));
+    }
+    if (j < numIndices) {
+        uint32_t tail[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        for (uint32_t k = 0; j + k < numIndices; ++k) {
+            tail[k] = indices[j + k];
+        }
+        hasher.addWords(
+            (uint64_t)tail[0] | ((uint64_t)tail[1] << 32),
+            (uint64_t)tail[2] | ((uint64_t)tail[3] << 32),
+            (uint64_t)tail[4] | ((uint64_t)tail[5] << 32),
+            (uint64_t)tail[6] | ((uint64_t)tail[7] << 32));
+    }
+}
+
+// helper function
+inline uint64_t getMeshContentSeed(const VectorOfPoints& points, const VectorOfIndices& triangleIndices) {
+    return ((uint64_t)points.size() << 32) | triangleIndices.size();
+}
+
+uint64_t hashMeshContent(const VectorOfPoints& points, const VectorOfIndices& triangleIndices) {
+    ContentHasher hasher(getMeshContentSeed(points, triangleIndices));
+    addMeshContent(points, triangleIndices, hasher);
+    return hasher.finish();
+}
+
+void hashMeshContent(const VectorOfPoints& points, const VectorOfIndices& triangleIndices, uint64_t& hash,
+        uint64_t& checkHash) {
+    DualContentHasher hasher(getMeshContentSeed(points, triangleIndices));
+    addMeshContent(points, triangleIndices, hasher);
+    hash = hasher.getFirst().finish();
+    checkHash = hasher.getSecond().finish();
+}
+
+MassPropertiesCache::MassPropertiesCache(uint32_t maxEntries, uint32_t numShards) :
+        m_shards(numShards > 0 ? numShards : 1) {
+    m_maxEntriesPerShard = maxEntries / m_shards.size();
+    if (m_maxEntriesPerShard == 0) {
+        m_maxEntriesPerShard = 1;
+    }
+}
+
+bool MassPropertiesCache::computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        MeshMassProperties& result) {
+    uint64_t hash, checkHash;
+    hashMeshContent(points, triangleIndices, hash, checkHash);
+    uint32_t numPoints = points.size();
+    uint32_t numIndices = triangleIndices.size();
+    // the low bits pick the bucket inside the shard's map so use the high bits for the shard
+    Shard& shard = m_shards[(hash >> 48) % m_shards.size()];
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::unordered_map<uint64_t, EntryList::iterator>::iterator itr = shard.index.find(hash);
+        if (itr != shard.index.end()) {
+            const Entry& entry = *(itr->second);
+            if (entry.checkHash == checkHash && entry.numPoints == numPoints && entry.numIndices == numIndices) {
+                shard.entries.splice(shard.entries.begin(), shard.entries, itr->second);
+                result = entry.result;
+                ++m_numHits;
+                return true;
+            }
+        }
+    }
+
+    // compute outside the lock so other threads are not blocked by the integration
+    ++m_numMisses;
+    result.computeMassProperties(points, triangleIndices);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<uint64_t, EntryList::iterator>::iterator itr = shard.index.find(hash);
+    if (itr != shard.index.end()) {
+        // another thread stored it meanwhile (or a colliding mesh is there): replace it
+        shard.entries.erase(itr->second);
+        shard.index.erase(itr);
+    }
+    Entry entry;
+    entry.hash = hash;
+    entry.checkHash = checkHash;
+    entry.numPoints = numPoints;
+    entry.numIndices = numIndices;
+    entry.result = result;
+    shard.entries.push_front(entry);
+    shard.index[hash] = shard.entries.begin();
+    while (shard.entries.size() > m_maxEntriesPerShard) {
+        shard.index.erase(shard.entries.back().hash);
+        shard.entries.pop_back();
+        ++m_numEvictions;
+    }
+    return false;
+}
+
+void MassPropertiesCache::clear() {
+    for (Shard& shard : m_shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.entries.clear();
+        shard.index.clear();
+    }
+}
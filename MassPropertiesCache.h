@@ -0,0 +1,72 @@
+//
+//  MassPropertiesCache.h
+//
+// Thread-safe cache of MeshMassProperties results keyed by the content of the mesh.
+
+#ifndef MASS_PROPERTIES_CACHE_H
+#define MASS_PROPERTIES_CACHE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "MeshMassProperties.h"
+
+// 64-bit hash of the point coordinates and triangle indices of a mesh.  Only the x, y, z
+// components of each point are hashed (the padding lane of btVector3 is ignored).
+uint64_t hashMeshContent(const VectorOfPoints& points, const VectorOfIndices& triangleIndices);
+
+// The same hash together with an independently seeded check hash of the same content,
+// computed in one pass.
+void hashMeshContent(const VectorOfPoints& points, const VectorOfIndices& triangleIndices, uint64_t& hash,
+        uint64_t& checkHash);
+
+// Meshes that are byte-identical (same points, same indices) have the same mass properties,
+// so duplicates can skip the integration entirely.  Lookups are spread over independently
+// locked shards so many threads can share one cache.  Each shard evicts its least recently
+// used entry once it holds more than its share of maxEntries.
+//
+// NOTE: entries are found by content hash and then verified against a second, independently
+// seeded hash and the point and index counts, not by a full comparison of the mesh data.
+// Distinct meshes would have to collide on both 64-bit hashes at once to share a result.
+class MassPropertiesCache {
+public:
+    MassPropertiesCache(uint32_t maxEntries = 1 << 16, uint32_t numShards = 16);
+
+    // Fetch the mass properties of the mesh, computing and storing them on a miss.
+    // Returns true when the result came from the cache.
+    bool computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            MeshMassProperties& result);
+
+    // forget all entries (counters are preserved)
+    void clear();
+
+    uint64_t getNumHits() const { return m_numHits; }
+    uint64_t getNumMisses() const { return m_numMisses; }
+    uint64_t getNumEvictions() const { return m_numEvictions; }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        uint64_t checkHash;
+        uint32_t numPoints;
+        uint32_t numIndices;
+        MeshMassProperties result;
+    };
+    typedef std::list<Entry> EntryList;
+
+    struct Shard {
+        std::mutex mutex;
+        EntryList entries; // most recently used at front
+        std::unordered_map<uint64_t, EntryList::iterator> index;
+    };
+
+    std::vector<Shard> m_shards;
+    uint32_t m_maxEntriesPerShard;
+    std::atomic<uint64_t> m_numHits { 0 };
+    std::atomic<uint64_t> m_numMisses { 0 };
+    std::atomic<uint64_t> m_numEvictions { 0 };
+};
+
+#endif // MASS_PROPERTIES_CACHE_H
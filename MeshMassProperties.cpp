@@ -9,8 +9,16 @@
 #include "MeshMassProperties.h"
 
 #include <assert.h>
+#include <float.h>
+#include <math.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ParallelFor.h"
+
 
 // this method is included for unit test verification
 void computeBoxInertia(btScalar mass, const btVector3& diagonal, btMatrix3x3& inertia) {
@@ -256,6 +264,567 @@ void applyInverseParallelAxisTheorem(btMatrix3x3& inertia, const btVector3& shif
 	}
 }
 
+// helper function
+void accumulateTetrahedron(const btVector3& p1, const btVector3& p2, const btVector3& p3,
+        btScalar& totalVolume, btVector3& weightedCenter, btMatrix3x3& totalInertia) {
+    // Tallies the tetrahedron formed by the origin and triangle {p1, p2, p3} into the totals.
+    // The inertia is accumulated about the origin.
+    btVector3 tetraPoints[4];
+    tetraPoints[0].setZero();
+    tetraPoints[1] = p1;
+    tetraPoints[2] = p2;
+    tetraPoints[3] = p3;
+
+    // compute volume
+    btScalar volume = computeTetrahedronVolume(tetraPoints);
+
+    // compute center
+    // NOTE: since tetraPoints[0] is the origin, we don't include it in the sum
+    btVector3 center = 0.25f * (tetraPoints[1] + tetraPoints[2] + tetraPoints[3]);
+
+    // shift vertices so that center of mass is at origin
+    tetraPoints[0] -= center;
+    tetraPoints[1] -= center;
+    tetraPoints[2] -= center;
+    tetraPoints[3] -= center;
+
+    // compute inertia tensor then shift it to origin-frame
+    btMatrix3x3 tetraInertia;
+    computeTetrahedronInertia(volume, tetraPoints, tetraInertia);
+    applyParallelAxisTheorem(tetraInertia, center, volume);
+
+    // tally results
+    weightedCenter += volume * center;
+    totalVolume += volume;
+    totalInertia += tetraInertia;
+}
+
+// One directed edge of a triangle, keyed by its undirected vertex pair so that all uses of
+// an edge sort next to each other.  The direction bit limits meshes to 2^31 triangles.
+struct EdgeRecord {
+    uint64_t key;       // (smaller vertex index << 32) | larger vertex index
+    uint32_t triangle;  // (triangle index << 1) | 1 if the edge runs from larger to smaller index
+};
+
+// helper function
+void addEdgeRecord(uint32_t triangle, uint32_t a, uint32_t b, std::vector<EdgeRecord>& edges) {
+    assert(triangle < (1u << 31));
+    // degenerate edges bound no area so they are not part of the topology
+    if (a != b) {
+        EdgeRecord edge;
+        if (a < b) {
+            edge.key = ((uint64_t)a << 32) | b;
+            edge.triangle = triangle << 1;
+        } else {
+            edge.key = ((uint64_t)b << 32) | a;
+            edge.triangle = (triangle << 1) | 1;
+        }
+        edges.push_back(edge);
+    }
+}
+
+// helper function
+void sortEdgeRecords(std::vector<EdgeRecord>& edges) {
+    // LSD radix sort with 16-bit digits.  Digits that are identical for every key are skipped,
+    // which for meshes with fewer than 65536 points removes half of the passes.  Big inputs are
+    // cut into contiguous chunks, each with its own histogram: the histogram and scatter passes
+    // run one chunk per task, and because chunk c's records land after those of chunks < c in
+    // every bucket the sort stays stable (and its output independent of the thread count).
+    // Small inputs would spend more time clearing histograms than sorting, so they are left to
+    // a comparison sort, which being stable gives the same order.
+    const uint32_t NUM_BUCKETS = 1 << 16;
+    const uint32_t MIN_EDGES_PER_CHUNK = 1 << 16;
+    const uint32_t MIN_RADIX_SORT_EDGES = 1 << 14;
+    uint32_t numEdges = edges.size();
+    if (numEdges < MIN_RADIX_SORT_EDGES) {
+        std::stable_sort(edges.begin(), edges.end(), [](const EdgeRecord& a, const EdgeRecord& b) {
+            return a.key < b.key;
+        });
+        return;
+    }
+    uint32_t numChunks = std::min(getParallelConcurrency(0), numEdges / MIN_EDGES_PER_CHUNK);
+    if (numChunks == 0) {
+        numChunks = 1;
+    }
+    uint32_t edgesPerChunk = (numEdges + numChunks - 1) / numChunks;
+    std::vector<uint32_t> counts((size_t)numChunks * NUM_BUCKETS);
+    std::vector<EdgeRecord> scratch(numEdges);
+    for (uint32_t shift = 0; shift < 64; shift += 16) {
+        parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+            for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+                uint32_t* chunkCounts = &counts[(size_t)chunk * NUM_BUCKETS];
+                std::fill(chunkCounts, chunkCounts + NUM_BUCKETS, 0);
+                uint32_t end = std::min(numEdges, (chunk + 1) * edgesPerChunk);
+                for (uint32_t i = chunk * edgesPerChunk; i < end; ++i) {
+                    ++chunkCounts[(edges[i].key >> shift) & (NUM_BUCKETS - 1)];
+                }
+            }
+        });
+        if (numEdges > 0) {
+            uint32_t firstBucket = (edges[0].key >> shift) & (NUM_BUCKETS - 1);
+            uint32_t count = 0;
+            for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+                count += counts[(size_t)chunk * NUM_BUCKETS + firstBucket];
+            }
+            if (count == numEdges) {
+                continue;
+            }
+        }
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+            for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+                uint32_t& slot = counts[(size_t)chunk * NUM_BUCKETS + i];
+                uint32_t count = slot;
+                slot = offset;
+                offset += count;
+            }
+        }
+        parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+            for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+                uint32_t* chunkOffsets = &counts[(size_t)chunk * NUM_BUCKETS];
+                uint32_t end = std::min(numEdges, (chunk + 1) * edgesPerChunk);
+                for (uint32_t i = chunk * edgesPerChunk; i < end; ++i) {
+                    const EdgeRecord& edge = edges[i];
+                    scratch[chunkOffsets[(edge.key >> shift) & (NUM_BUCKETS - 1)]++] = edge;
+                }
+            }
+        });
+        edges.swap(scratch);
+    }
+}
+
+// helper function
+uint32_t findOrientationRoot(uint32_t triangle, std::vector<uint32_t>& parent, std::vector<uint8_t>& parity, uint8_t& rootParity) {
+    // union-find lookup where each node also stores whether its winding is opposite to its parent
+    uint32_t root = triangle;
+    uint8_t p = 0;
+    while (parent[root] != root) {
+        p ^= parity[root];
+        root = parent[root];
+    }
+    rootParity = p;
+
+    // compress the path
+    uint32_t node = triangle;
+    while (node != root && parent[node] != root) {
+        uint32_t next = parent[node];
+        uint8_t nextParity = p ^ parity[node];
+        parent[node] = root;
+        parity[node] = p;
+        node = next;
+        p = nextParity;
+    }
+    return root;
+}
+
+// Two triangles that share a manifold edge, and whether their windings are opposite.
+struct OrientationPair {
+    uint32_t first;
+    uint32_t second;
+    uint8_t relativeParity;
+};
+
+// helper function
+void uniteOrientations(const OrientationPair& pair, std::vector<uint32_t>& parent, std::vector<uint32_t>& size,
+        std::vector<uint8_t>& parity) {
+    uint8_t parityA, parityB;
+    uint32_t rootA = findOrientationRoot(pair.first, parent, parity, parityA);
+    uint32_t rootB = findOrientationRoot(pair.second, parent, parity, parityB);
+    if (rootA != rootB) {
+        if (size[rootA] < size[rootB]) {
+            std::swap(rootA, rootB);
+        }
+        parent[rootB] = rootA;
+        parity[rootB] = parityA ^ parityB ^ pair.relativeParity;
+        size[rootA] += size[rootB];
+    }
+}
+
+uint32_t computeOrientationSigns(const VectorOfPoints& points, const VectorOfIndices& triangleIndices, VectorOfSigns& signs) {
+    // Triangles that share a manifold edge are joined into components by a union-find that also
+    // tracks relative winding: two triangles agree when they traverse the shared edge in
+    // opposite directions.  Each component is then made to have positive signed volume.
+    // Non-manifold edges carry no orientation information and are ignored, as are edges that
+    // contradict the winding already established for their component (non-orientable surfaces).
+    //
+    // The triangles are cut into contiguous chunks.  Pairs within one chunk only ever touch that
+    // chunk's slice of the union-find, so the chunks are joined in parallel; the pairs that
+    // cross chunks are then merged on one thread.  Meshes are usually stored with neighbors
+    // close together, which leaves few crossing pairs.  The chunk size is fixed rather than
+    // derived from the thread count: on non-orientable input the pairs that are dropped as
+    // contradictions depend on the order of the unions, and that order must be the same on
+    // every machine.
+    const uint32_t TRIANGLES_PER_CHUNK = 1 << 14;
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    std::vector<EdgeRecord> edges;
+    edges.reserve(3 * numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        addEdgeRecord(i, triangleIndices[t], triangleIndices[t + 1], edges);
+        addEdgeRecord(i, triangleIndices[t + 1], triangleIndices[t + 2], edges);
+        addEdgeRecord(i, triangleIndices[t + 2], triangleIndices[t], edges);
+    }
+    sortEdgeRecords(edges);
+
+    uint32_t numChunks = numTriangles / TRIANGLES_PER_CHUNK + 1;
+    uint32_t trianglesPerChunk = TRIANGLES_PER_CHUNK;
+
+    // the last list holds the pairs that cross chunks
+    std::vector<std::vector<OrientationPair>> pairs(numChunks + 1);
+    uint32_t numEdges = edges.size();
+    uint32_t i = 0;
+    while (i < numEdges) {
+        uint32_t j = i + 1;
+        while (j < numEdges && edges[j].key == edges[i].key) {
+            ++j;
+        }
+        if (j - i == 2) {
+            OrientationPair pair;
+            pair.first = edges[i].triangle >> 1;
+            pair.second = edges[i + 1].triangle >> 1;
+            pair.relativeParity = (edges[i].triangle & 1) == (edges[i + 1].triangle & 1) ? 1 : 0;
+            uint32_t chunk = pair.first / trianglesPerChunk;
+            pairs[(chunk == pair.second / trianglesPerChunk) ? chunk : numChunks].push_back(pair);
+        }
+        i = j;
+    }
+
+    std::vector<uint32_t> parent(numTriangles);
+    std::vector<uint32_t> size(numTriangles, 1);
+    std::vector<uint8_t> parity(numTriangles, 0);
+    for (uint32_t k = 0; k < numTriangles; ++k) {
+        parent[k] = k;
+    }
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            for (const OrientationPair& pair : pairs[chunk]) {
+                uniteOrientations(pair, parent, size, parity);
+            }
+        }
+    });
+    for (const OrientationPair& pair : pairs[numChunks]) {
+        uniteOrientations(pair, parent, size, parity);
+    }
+
+    // signed volume of each triangle as given
+    std::vector<double> triangleVolume(numTriangles);
+    parallelFor(numTriangles, trianglesPerChunk, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t k = begin; k < end; ++k) {
+            uint32_t t = 3 * k;
+            assert(triangleIndices[t] < numPoints);
+            assert(triangleIndices[t + 1] < numPoints);
+            assert(triangleIndices[t + 2] < numPoints);
+            const btVector3& p1 = points[triangleIndices[t]];
+            const btVector3& p2 = points[triangleIndices[t + 1]];
+            const btVector3& p3 = points[triangleIndices[t + 2]];
+            triangleVolume[k] = p1.dot(p2.cross(p3));
+        }
+    });
+
+    // sum the signed volume of each component as it would be after making it consistent
+    std::vector<double> componentVolume(numTriangles, 0.0);
+    signs.resize(numTriangles);
+    for (uint32_t k = 0; k < numTriangles; ++k) {
+        uint8_t p;
+        uint32_t root = findOrientationRoot(k, parent, parity, p);
+        componentVolume[root] += p ? -triangleVolume[k] : triangleVolume[k];
+        signs[k] = p ? -1 : 1;
+    }
+
+    // flip whole components that came out inside-out
+    uint32_t numFlipped = 0;
+    for (uint32_t k = 0; k < numTriangles; ++k) {
+        if (componentVolume[parent[k]] < 0.0) {
+            signs[k] = -signs[k];
+        }
+        if (signs[k] < 0) {
+            ++numFlipped;
+        }
+    }
+    return numFlipped;
+}
+
+void applyOrientationSigns(const VectorOfSigns& signs, VectorOfIndices& triangleIndices) {
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    assert(signs.size() >= numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        if (signs[i] < 0) {
+            std::swap(triangleIndices[3 * i + 1], triangleIndices[3 * i + 2]);
+        }
+    }
+}
+
+void MassPropertiesAccumulator::clear() {
+    m_volume = 0.0f;
+    m_mass = 0.0f;
+    m_weightedCenter.setZero();
+    for (uint32_t i = 0; i < 3; ++i) {
+        m_inertia[i].setZero();
+    }
+}
+
+void MassPropertiesAccumulator::addTriangle(const btVector3& p1, const btVector3& p2, const btVector3& p3) {
+    btScalar volume = 0.0f;
+    accumulateTetrahedron(p1, p2, p3, volume, m_weightedCenter, m_inertia);
+    m_volume += volume;
+    m_mass += volume;
+}
+
+void MassPropertiesAccumulator::addTetrahedron(const btVector3* points, btScalar density) {
+    btVector3 tetraPoints[4] = { points[0], points[1], points[2], points[3] };
+    btScalar volume = btFabs(computeTetrahedronVolume(tetraPoints));
+    btScalar mass = density * volume;
+
+    // shift vertices so that center of mass is at origin
+    btVector3 center = 0.25f * (tetraPoints[0] + tetraPoints[1] + tetraPoints[2] + tetraPoints[3]);
+    for (uint32_t i = 0; i < 4; ++i) {
+        tetraPoints[i] -= center;
+    }
+
+    // compute inertia tensor then shift it to origin-frame
+    btMatrix3x3 tetraInertia;
+    computeTetrahedronInertia(mass, tetraPoints, tetraInertia);
+    applyParallelAxisTheorem(tetraInertia, center, mass);
+
+    m_volume += volume;
+    m_mass += mass;
+    m_weightedCenter += mass * center;
+    m_inertia += tetraInertia;
+}
+
+void MassPropertiesAccumulator::addMassProperties(const MeshMassProperties& body) {
+    // shift the body's inertia from its center of mass to the origin before adding it
+    btMatrix3x3 inertia = body.m_inertia;
+    applyParallelAxisTheorem(inertia, body.m_centerOfMass, body.m_mass);
+    m_volume += body.m_volume;
+    m_mass += body.m_mass;
+    m_weightedCenter += body.m_mass * body.m_centerOfMass;
+    m_inertia += inertia;
+}
+
+void MassPropertiesAccumulator::addTotals(const MassPropertiesAccumulator& other) {
+    m_volume += other.m_volume;
+    m_mass += other.m_mass;
+    m_weightedCenter += other.m_weightedCenter;
+    m_inertia += other.m_inertia;
+}
+
+void MassPropertiesAccumulator::getMassProperties(MeshMassProperties& result) const {
+    result.m_volume = m_volume;
+    result.m_mass = m_mass;
+    if (m_mass == 0.0f) {
+        // nothing to balance: leave the center at the origin and the inertia about it
+        result.m_centerOfMass.setZero();
+        result.m_inertia = m_inertia;
+        return;
+    }
+
+    // move the inertia from the origin to the center of mass
+    result.m_centerOfMass = m_weightedCenter / m_mass;
+    result.m_inertia = m_inertia;
+    applyInverseParallelAxisTheorem(result.m_inertia, result.m_centerOfMass, m_mass);
+}
+
+void transformMassProperties(MeshMassProperties& properties, const btMatrix3x3& linear, const btVector3& translation) {
+    // Under x' = L * x + t the second moment about the center of mass transforms as
+    //
+    //     C' = |det(L)| * L * C * L^T
+    //
+    // where C is recovered from the inertia tensor I = trace(C) * E - C, so C = (trace(I) / 2) * E - I.
+    btScalar scale = btFabs(linear.determinant());
+    const btMatrix3x3& inertia = properties.m_inertia;
+    btScalar halfTrace = 0.5f * (inertia[0][0] + inertia[1][1] + inertia[2][2]);
+    btMatrix3x3 secondMoment;
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            secondMoment[i][j] = (i == j ? halfTrace : 0.0f) - inertia[i][j];
+        }
+    }
+    secondMoment = linear * secondMoment * linear.transpose();
+    btScalar trace = scale * (secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2]);
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            properties.m_inertia[i][j] = (i == j ? trace : 0.0f) - scale * secondMoment[i][j];
+        }
+    }
+    properties.m_volume *= scale;
+    properties.m_mass *= scale;
+    properties.m_centerOfMass = linear * properties.m_centerOfMass + translation;
+}
+
+// Exact signed 128-bit accumulator built from 64-bit halves.  Additions wrap like any two's
+// complement integer, so intermediate overflow is harmless as long as the final sum fits.
+struct ExactSum128 {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    void add(int64_t value) {
+        uint64_t valueLo = (uint64_t)value;
+        uint64_t valueHi = (value < 0) ? ~(uint64_t)0 : 0;
+        lo += valueLo;
+        hi += valueHi + (lo < valueLo ? 1 : 0);
+    }
+
+    void addProduct(int64_t a, int64_t b) {
+        // 64x64 --> 128 bit product from 32-bit pieces of the magnitudes
+        bool negative = (a < 0) != (b < 0);
+        uint64_t ua = (a < 0) ? (uint64_t)0 - (uint64_t)a : (uint64_t)a;
+        uint64_t ub = (b < 0) ? (uint64_t)0 - (uint64_t)b : (uint64_t)b;
+        const uint64_t MASK = 0xffffffff;
+        uint64_t p00 = (ua & MASK) * (ub & MASK);
+        uint64_t p01 = (ua & MASK) * (ub >> 32);
+        uint64_t p10 = (ua >> 32) * (ub & MASK);
+        uint64_t p11 = (ua >> 32) * (ub >> 32);
+        uint64_t middle = (p00 >> 32) + (p01 & MASK) + (p10 & MASK);
+        uint64_t productLo = (middle << 32) | (p00 & MASK);
+        uint64_t productHi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+        if (negative) {
+            productLo = ~productLo + 1;
+            productHi = ~productHi + (productLo == 0 ? 1 : 0);
+        }
+        lo += productLo;
+        hi += productHi + (lo < productLo ? 1 : 0);
+    }
+
+    double toDouble() const {
+        bool negative = (hi >> 63) != 0;
+        uint64_t magnitudeLo = negative ? ~lo + 1 : lo;
+        uint64_t magnitudeHi = negative ? ~hi + (magnitudeLo == 0 ? 1 : 0) : hi;
+        double value = (double)magnitudeHi * 18446744073709551616.0 + (double)magnitudeLo;
+        return negative ? -value : value;
+    }
+};
+
+// helper function
+inline double roundedProduct(double a, double b) {
+    // Storing through volatile forces the product to be rounded on its own, which keeps the
+    // compiler from fusing it into a multiply-add (fused and unfused results differ).
+    volatile double product = a * b;
+    return product;
+}
+
+bool MeshMassProperties::computeDeterministicMassProperties(const VectorOfPoints& points,
+        const VectorOfIndices& triangleIndices, btScalar gridSize) {
+    // The integrals over the tetrahedron {origin, a, b, c} with det = a.dot(b.cross(c)) are:
+    //
+    //     volume        = det / 6
+    //     first moment  = det * (a + b + c) / 24
+    //     second moment = det * (a a^T + b b^T + c c^T + s s^T) / 120      where s = a + b + c
+    //
+    // With integer coordinates each numerator is an integer, so the sums over all triangles
+    // are exact.  The points are first made relative to an integer reference point near the
+    // middle of the mesh, which keeps the products small and avoids cancellation when the
+    // second moment is moved to the center of mass.
+    const int64_t MAX_COORDINATE = 1 << 18;
+    uint32_t numPoints = points.size();
+    std::vector<int64_t> grid(3 * numPoints);
+    int64_t sum[3] = { 0, 0, 0 };
+    double inverseGridSize = 1.0 / (double)gridSize;
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            double snapped = nearbyint((double)points[i][k] * inverseGridSize);
+            if (!(snapped >= -MAX_COORDINATE && snapped <= MAX_COORDINATE)) {
+                return false;
+            }
+            grid[3 * i + k] = (int64_t)snapped;
+            sum[k] += grid[3 * i + k];
+        }
+    }
+    int64_t reference[3] = { 0, 0, 0 };
+    if (numPoints > 0) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            reference[k] = sum[k] / (int64_t)numPoints;
+        }
+    }
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            grid[3 * i + k] -= reference[k];
+        }
+    }
+
+    ExactSum128 det6;
+    ExactSum128 first24[3];
+    ExactSum128 second120[6]; // xx, yy, zz, xy, xz, yz
+    const uint32_t ROW[6] = { 0, 1, 2, 0, 0, 1 };
+    const uint32_t COLUMN[6] = { 0, 1, 2, 1, 2, 2 };
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        assert(triangleIndices[t] < numPoints);
+        assert(triangleIndices[t + 1] < numPoints);
+        assert(triangleIndices[t + 2] < numPoints);
+        const int64_t* a = &grid[3 * triangleIndices[t]];
+        const int64_t* b = &grid[3 * triangleIndices[t + 1]];
+        const int64_t* c = &grid[3 * triangleIndices[t + 2]];
+
+        // |coordinates| <= 2^19 so det fits comfortably in 64 bits
+        int64_t det = a[0] * (b[1] * c[2] - b[2] * c[1])
+            + a[1] * (b[2] * c[0] - b[0] * c[2])
+            + a[2] * (b[0] * c[1] - b[1] * c[0]);
+        int64_t s[3] = { a[0] + b[0] + c[0], a[1] + b[1] + c[1], a[2] + b[2] + c[2] };
+
+        det6.add(det);
+        for (uint32_t k = 0; k < 3; ++k) {
+            first24[k].addProduct(det, s[k]);
+        }
+        for (uint32_t k = 0; k < 6; ++k) {
+            uint32_t row = ROW[k];
+            uint32_t column = COLUMN[k];
+            int64_t bracket = a[row] * a[column] + b[row] * b[column] + c[row] * c[column] + s[row] * s[column];
+            second120[k].addProduct(det, bracket);
+        }
+    }
+
+    // Only now convert to floating point.  Every operation below is a single correctly rounded
+    // IEEE operation on values that depend only on the snapped input.
+    double D = det6.toDouble();
+    double h = (double)gridSize;
+    if (D == 0.0) {
+        // a flat or empty mesh encloses nothing: report it at the reference point
+        m_volume = 0.0f;
+        m_mass = 0.0f;
+        for (uint32_t k = 0; k < 3; ++k) {
+            m_centerOfMass[k] = (btScalar)roundedProduct((double)reference[k], h);
+        }
+        m_inertia.setValue(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+        return true;
+    }
+    double h3 = roundedProduct(roundedProduct(h, h), h);
+    double h5 = roundedProduct(roundedProduct(h3, h), h);
+    double F[3];
+    for (uint32_t k = 0; k < 3; ++k) {
+        F[k] = first24[k].toDouble();
+    }
+
+    // second moment about the center of mass: S / 120 - F F^T / (96 D)
+    double secondMoment[3][3];
+    double inverse96D = 1.0 / roundedProduct(96.0, D);
+    for (uint32_t k = 0; k < 6; ++k) {
+        uint32_t row = ROW[k];
+        uint32_t column = COLUMN[k];
+        double shift = roundedProduct(roundedProduct(F[row], F[column]), inverse96D);
+        double value = second120[k].toDouble() / 120.0 - shift;
+        secondMoment[row][column] = value;
+        secondMoment[column][row] = value;
+    }
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+
+    m_volume = (btScalar)roundedProduct(D / 6.0, h3);
+    m_mass = m_volume;
+    double inverse4D = 1.0 / roundedProduct(4.0, D);
+    for (uint32_t k = 0; k < 3; ++k) {
+        m_centerOfMass[k] = (btScalar)roundedProduct((double)reference[k] + roundedProduct(F[k], inverse4D), h);
+    }
+    for (uint32_t row = 0; row < 3; ++row) {
+        for (uint32_t column = 0; column < 3; ++column) {
+            double value = (row == column ? trace : 0.0) - secondMoment[row][column];
+            m_inertia[row][column] = (btScalar)roundedProduct(value, h5);
+        }
+    }
+    return true;
+}
+
 MeshMassProperties::MeshMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices) {
     computeMassProperties(points, triangleIndices);
 }
@@ -270,60 +839,793 @@ void MeshMassProperties::computeMassProperties(const VectorOfPoints& points, con
     //
 
     // initialize the totals
-    m_volume = 0.0f;
-    btVector3 weightedCenter;
-    weightedCenter.setZero();
+    MassPropertiesAccumulator totals;
+
+    // loop over triangles
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        assert(triangleIndices[t] < numPoints);
+        assert(triangleIndices[t + 1] < numPoints);
+        assert(triangleIndices[t + 2] < numPoints);
+        totals.addTriangle(points[triangleIndices[t]], points[triangleIndices[t + 1]], points[triangleIndices[t + 2]]);
+    }
+
+    totals.getMassProperties(*this);
+}
+
+void MeshMassProperties::computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        MeshTopologyReport& report) {
+    // Same integration as above, but while each triangle is in hand we also emit its three
+    // directed edges.  Sorting the edges by vertex pair brings every use of an edge together,
+    // after which a single scan classifies them:
+    //
+    // one use                      --> boundary edge (mesh is open)
+    // two uses, opposite direction --> manifold edge (good)
+    // two uses, same direction     --> misoriented edge (neighbors disagree on winding)
+    // more than two uses           --> non-manifold edge
+    //
+    // A triangle is reported as flipped when most of its paired edges are misoriented.
+
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    std::vector<EdgeRecord> edges;
+    edges.reserve(3 * numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        uint32_t a = triangleIndices[t];
+        uint32_t b = triangleIndices[t + 1];
+        uint32_t c = triangleIndices[t + 2];
+        assert(a < numPoints);
+        assert(b < numPoints);
+        assert(c < numPoints);
+        totals.addTriangle(points[a], points[b], points[c]);
+        addEdgeRecord(i, a, b, edges);
+        addEdgeRecord(i, b, c, edges);
+        addEdgeRecord(i, c, a, edges);
+    }
+
+    totals.getMassProperties(*this);
+
+    // classify edges
+    sortEdgeRecords(edges);
+    report.m_numBoundaryEdges = 0;
+    report.m_numNonManifoldEdges = 0;
+    report.m_numMisorientedEdges = 0;
+    report.m_flippedTriangles.clear();
+    std::vector<uint8_t> numPairedEdges(numTriangles, 0);
+    std::vector<uint8_t> numMisorientedEdges(numTriangles, 0);
+    uint32_t numEdges = edges.size();
+    uint32_t i = 0;
+    while (i < numEdges) {
+        uint32_t j = i + 1;
+        while (j < numEdges && edges[j].key == edges[i].key) {
+            ++j;
+        }
+        uint32_t numUses = j - i;
+        if (numUses == 1) {
+            ++report.m_numBoundaryEdges;
+        } else if (numUses == 2) {
+            uint32_t first = edges[i].triangle >> 1;
+            uint32_t second = edges[i + 1].triangle >> 1;
+            ++numPairedEdges[first];
+            ++numPairedEdges[second];
+            if ((edges[i].triangle & 1) == (edges[i + 1].triangle & 1)) {
+                ++report.m_numMisorientedEdges;
+                ++numMisorientedEdges[first];
+                ++numMisorientedEdges[second];
+            }
+        } else {
+            ++report.m_numNonManifoldEdges;
+        }
+        i = j;
+    }
+    for (uint32_t k = 0; k < numTriangles; ++k) {
+        if (2 * numMisorientedEdges[k] > numPairedEdges[k]) {
+            report.m_flippedTriangles.push_back(k);
+        }
+    }
+}
+
+void MeshMassProperties::computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        const VectorOfSigns& triangleSigns) {
+    // Same as the plain variant except that triangles with negative sign are integrated
+    // with their winding reversed.
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    assert(triangleSigns.size() >= numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        assert(triangleIndices[t] < numPoints);
+        assert(triangleIndices[t + 1] < numPoints);
+        assert(triangleIndices[t + 2] < numPoints);
+        const btVector3& p1 = points[triangleIndices[t]];
+        const btVector3& p2 = points[triangleIndices[t + 1]];
+        const btVector3& p3 = points[triangleIndices[t + 2]];
+        if (triangleSigns[i] < 0) {
+            totals.addTriangle(p1, p3, p2);
+        } else {
+            totals.addTriangle(p1, p2, p3);
+        }
+    }
+
+    totals.getMassProperties(*this);
+}
+
+uint32_t MeshMassProperties::computeMassPropertiesWithCappedHoles(const VectorOfPoints& points,
+        const VectorOfIndices& triangleIndices) {
+    // Boundary edges (edges used by only one triangle) are found with the same directed-edge
+    // pairing used for validation, chained into loops, and each loop is closed by a fan of
+    // triangles about the loop's centroid.  The fan triangles are integrated straight into
+    // the running totals; the mesh itself is never modified or copied.
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    std::vector<EdgeRecord> edges;
+    edges.reserve(3 * numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        uint32_t a = triangleIndices[t];
+        uint32_t b = triangleIndices[t + 1];
+        uint32_t c = triangleIndices[t + 2];
+        assert(a < numPoints);
+        assert(b < numPoints);
+        assert(c < numPoints);
+        totals.addTriangle(points[a], points[b], points[c]);
+        addEdgeRecord(i, a, b, edges);
+        addEdgeRecord(i, b, c, edges);
+        addEdgeRecord(i, c, a, edges);
+    }
+    sortEdgeRecords(edges);
+
+    // collect boundary edges as (from << 32 | to) so that sorting groups them by start vertex
+    std::vector<uint64_t> boundary;
+    uint32_t numEdges = edges.size();
+    uint32_t i = 0;
+    while (i < numEdges) {
+        uint32_t j = i + 1;
+        while (j < numEdges && edges[j].key == edges[i].key) {
+            ++j;
+        }
+        if (j - i == 1) {
+            uint64_t key = edges[i].key;
+            if (edges[i].triangle & 1) {
+                key = (key << 32) | (key >> 32);
+            }
+            boundary.push_back(key);
+        }
+        i = j;
+    }
+    std::sort(boundary.begin(), boundary.end());
+
+    // walk the loops
+    uint32_t numLoops = 0;
+    uint32_t numBoundaryEdges = boundary.size();
+    std::vector<uint8_t> used(numBoundaryEdges, 0);
+    VectorOfIndices loop;
+    for (uint32_t start = 0; start < numBoundaryEdges; ++start) {
+        if (used[start]) {
+            continue;
+        }
+        loop.clear();
+        uint32_t firstVertex = (uint32_t)(boundary[start] >> 32);
+        uint32_t edge = start;
+        while (edge < numBoundaryEdges) {
+            used[edge] = 1;
+            loop.push_back(edge);
+            uint32_t to = (uint32_t)boundary[edge];
+            if (to == firstVertex) {
+                break;
+            }
+            // find an unused edge leaving 'to'
+            std::vector<uint64_t>::const_iterator itr = std::lower_bound(boundary.begin(), boundary.end(), (uint64_t)to << 32);
+            edge = numBoundaryEdges;
+            for (uint32_t k = itr - boundary.begin(); k < numBoundaryEdges && (uint32_t)(boundary[k] >> 32) == to; ++k) {
+                if (!used[k]) {
+                    edge = k;
+                    break;
+                }
+            }
+        }
+
+        // integrate the fan cap
+        btVector3 centroid(0.0f, 0.0f, 0.0f);
+        for (uint32_t k : loop) {
+            centroid += points[(uint32_t)(boundary[k] >> 32)];
+        }
+        centroid /= (btScalar)loop.size();
+        for (uint32_t k : loop) {
+            const btVector3& from = points[(uint32_t)(boundary[k] >> 32)];
+            const btVector3& to = points[(uint32_t)boundary[k]];
+            totals.addTriangle(to, from, centroid);
+        }
+        ++numLoops;
+    }
+
+    totals.getMassProperties(*this);
+    return numLoops;
+}
+
+void MeshMassProperties::computeMassPropertiesOfStrips(const VectorOfPoints& points, const VectorOfIndices& stripIndices,
+        uint32_t restartIndex) {
+    // Slide a window of two points along each strip so that every index costs one gather.
+    // Odd triangles swap their first two points to keep the strip's winding.  Triangles that
+    // repeat a point (used to stitch strips together) have no volume and are skipped.
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numIndices = stripIndices.size();
+    uint32_t i = 0;
+    while (i < numIndices) {
+        // start a new strip
+        while (i < numIndices && stripIndices[i] == restartIndex) {
+            ++i;
+        }
+        if (i + 2 >= numIndices) {
+            break;
+        }
+        uint32_t a = stripIndices[i];
+        uint32_t b = stripIndices[i + 1];
+        if (b == restartIndex) {
+            i += 2;
+            continue;
+        }
+        assert(a < numPoints);
+        assert(b < numPoints);
+        const btVector3* pa = &points[a];
+        const btVector3* pb = &points[b];
+        bool odd = false;
+        for (i += 2; i < numIndices; ++i) {
+            uint32_t c = stripIndices[i];
+            if (c == restartIndex) {
+                break;
+            }
+            assert(c < numPoints);
+            const btVector3* pc = &points[c];
+            if (a != b && b != c && c != a) {
+                if (odd) {
+                    totals.addTriangle(*pb, *pa, *pc);
+                } else {
+                    totals.addTriangle(*pa, *pb, *pc);
+                }
+            }
+            a = b;
+            b = c;
+            pa = pb;
+            pb = pc;
+            odd = !odd;
+        }
+    }
+
+    totals.getMassProperties(*this);
+}
+
+void MeshMassProperties::computeMassPropertiesOfFans(const VectorOfPoints& points, const VectorOfIndices& fanIndices,
+        uint32_t restartIndex) {
+    // The pivot stays put and the last point slides along the rim, so again each index costs
+    // one gather.
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numIndices = fanIndices.size();
+    uint32_t i = 0;
+    while (i < numIndices) {
+        // start a new fan
+        while (i < numIndices && fanIndices[i] == restartIndex) {
+            ++i;
+        }
+        if (i + 2 >= numIndices) {
+            break;
+        }
+        uint32_t pivot = fanIndices[i];
+        uint32_t b = fanIndices[i + 1];
+        if (b == restartIndex) {
+            i += 2;
+            continue;
+        }
+        assert(pivot < numPoints);
+        assert(b < numPoints);
+        const btVector3& p0 = points[pivot];
+        const btVector3* pb = &points[b];
+        for (i += 2; i < numIndices; ++i) {
+            uint32_t c = fanIndices[i];
+            if (c == restartIndex) {
+                break;
+            }
+            assert(c < numPoints);
+            const btVector3* pc = &points[c];
+            if (b != c && c != pivot && b != pivot) {
+                totals.addTriangle(p0, *pb, *pc);
+            }
+            b = c;
+            pb = pc;
+        }
+    }
+
+    totals.getMassProperties(*this);
+}
+
+void MeshMassProperties::computeMassPropertiesOfPolygons(const VectorOfPoints& points, const VectorOfIndices& faceSizes,
+        const VectorOfIndices& faceIndices) {
+    // Each face is fanned about its first point.  Faces with fewer than three points have no area.
+    MassPropertiesAccumulator totals;
+
+    uint32_t numPoints = points.size();
+    uint32_t numFaces = faceSizes.size();
+    uint32_t numIndices = faceIndices.size();
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < numFaces; ++i) {
+        uint32_t size = faceSizes[i];
+        assert(first + size <= numIndices);
+        const uint32_t* face = &faceIndices[first];
+        first += size;
+        if (size > 2) {
+            assert(face[0] < numPoints);
+            const btVector3& p0 = points[face[0]];
+            for (uint32_t j = 2; j < size; ++j) {
+                assert(face[j - 1] < numPoints);
+                assert(face[j] < numPoints);
+                totals.addTriangle(p0, points[face[j - 1]], points[face[j]]);
+            }
+        }
+    }
+    assert(first == numIndices);
+
+    totals.getMassProperties(*this);
+}
+
+// Keast's 11 point rule, exact for polynomials of degree four over a tetrahedron.  Each point
+// is given by the barycentric weights of the last three corners (the first corner is the
+// origin); the weights sum to 1/6, the volume of the unit tetrahedron.
+const uint32_t NUM_KEAST_POINTS = 11;
+const double KEAST_POINTS[NUM_KEAST_POINTS][3] = {
+    { 0.25, 0.25, 0.25 },
+    { 0.0714285714285714285714285714286, 0.0714285714285714285714285714286, 0.0714285714285714285714285714286 },
+    { 0.785714285714285714285714285714, 0.0714285714285714285714285714286, 0.0714285714285714285714285714286 },
+    { 0.0714285714285714285714285714286, 0.785714285714285714285714285714, 0.0714285714285714285714285714286 },
+    { 0.0714285714285714285714285714286, 0.0714285714285714285714285714286, 0.785714285714285714285714285714 },
+    { 0.399403576166799219, 0.399403576166799219, 0.100596423833200785 },
+    { 0.399403576166799219, 0.100596423833200785, 0.399403576166799219 },
+    { 0.100596423833200785, 0.399403576166799219, 0.399403576166799219 },
+    { 0.399403576166799219, 0.100596423833200785, 0.100596423833200785 },
+    { 0.100596423833200785, 0.399403576166799219, 0.100596423833200785 },
+    { 0.100596423833200785, 0.100596423833200785, 0.399403576166799219 } };
+const double KEAST_WEIGHTS[NUM_KEAST_POINTS] = {
+    -0.0131555555555555555555555555556,
+    0.00762222222222222222222222222222, 0.00762222222222222222222222222222,
+    0.00762222222222222222222222222222, 0.00762222222222222222222222222222,
+    0.0248888888888888888888888888889, 0.0248888888888888888888888888889, 0.0248888888888888888888888888889,
+    0.0248888888888888888888888888889, 0.0248888888888888888888888888889, 0.0248888888888888888888888888889 };
+
+// Integrals of every monomial up to degree four over a region, stored as full symmetric
+// tensors (only entries with non-decreasing indices are accumulated).
+struct PolynomialMoments {
+    double m0 = 0.0;
+    double m1[3] = { 0.0, 0.0, 0.0 };
+    double m2[3][3] = {};
+    double m3[3][3][3] = {};
+    double m4[3][3][3][3] = {};
+
+    void addPoint(double weight, const double* x) {
+        m0 += weight;
+        for (uint32_t i = 0; i < 3; ++i) {
+            double wi = weight * x[i];
+            m1[i] += wi;
+            for (uint32_t j = i; j < 3; ++j) {
+                double wij = wi * x[j];
+                m2[i][j] += wij;
+                for (uint32_t k = j; k < 3; ++k) {
+                    double wijk = wij * x[k];
+                    m3[i][j][k] += wijk;
+                    for (uint32_t l = k; l < 3; ++l) {
+                        m4[i][j][k][l] += wijk * x[l];
+                    }
+                }
+            }
+        }
+    }
+
+    void add(const PolynomialMoments& other) {
+        m0 += other.m0;
+        for (uint32_t i = 0; i < 3; ++i) {
+            m1[i] += other.m1[i];
+            for (uint32_t j = i; j < 3; ++j) {
+                m2[i][j] += other.m2[i][j];
+                for (uint32_t k = j; k < 3; ++k) {
+                    m3[i][j][k] += other.m3[i][j][k];
+                    for (uint32_t l = k; l < 3; ++l) {
+                        m4[i][j][k][l] += other.m4[i][j][k][l];
+                    }
+                }
+            }
+        }
+    }
+
+    // copy the accumulated entries to every permutation of their indices
+    void symmetrize() {
+        for (uint32_t i = 0; i < 3; ++i) {
+            for (uint32_t j = 0; j < 3; ++j) {
+                uint32_t sorted2[2] = { i, j };
+                std::sort(sorted2, sorted2 + 2);
+                m2[i][j] = m2[sorted2[0]][sorted2[1]];
+                for (uint32_t k = 0; k < 3; ++k) {
+                    uint32_t sorted3[3] = { i, j, k };
+                    std::sort(sorted3, sorted3 + 3);
+                    m3[i][j][k] = m3[sorted3[0]][sorted3[1]][sorted3[2]];
+                    for (uint32_t l = 0; l < 3; ++l) {
+                        uint32_t sorted4[4] = { i, j, k, l };
+                        std::sort(sorted4, sorted4 + 4);
+                        m4[i][j][k][l] = m4[sorted4[0]][sorted4[1]][sorted4[2]][sorted4[3]];
+                    }
+                }
+            }
+        }
+    }
+};
+
+// triangles integrated against a density by one thread at a time
+const uint32_t DENSITY_TRIANGLES_PER_CHUNK = 4096;
+
+void MeshMassProperties::computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        const DensityPolynomial& density, uint32_t numThreads) {
+    // The mass, first moment and second moment are integrals of density times 1, x and x x^T,
+    // so with a quadratic density they need every monomial integral up to degree four.  Those
+    // are summed over the origin tetrahedra of the triangles with Keast's rule and contracted
+    // with the density coefficients at the end.
+    //
+    // The points are taken relative to their centroid r to keep the sums well conditioned; the
+    // density is re-expanded about r to match:
+    //
+    //     density(y + r) = (c + g.r + r^T H r) + (g + 2 H r).y + y^T H y
+    uint32_t numPoints = points.size();
+    double reference[3] = { 0.0, 0.0, 0.0 };
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            reference[k] += points[i][k];
+        }
+    }
+    if (numPoints > 0) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            reference[k] /= numPoints;
+        }
+    }
+    double quadratic[3][3];
     for (uint32_t i = 0; i < 3; ++i) {
-        m_inertia[i].setZero();
+        for (uint32_t j = 0; j < 3; ++j) {
+            quadratic[i][j] = 0.5 * ((double)density.m_quadratic[i][j] + (double)density.m_quadratic[j][i]);
+        }
+    }
+    double constant = density.m_constant;
+    double linear[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        constant += density.m_linear[i] * reference[i];
+        linear[i] = density.m_linear[i];
+        for (uint32_t j = 0; j < 3; ++j) {
+            constant += reference[i] * quadratic[i][j] * reference[j];
+            linear[i] += 2.0 * quadratic[i][j] * reference[j];
+        }
+    }
+
+    // Each chunk of triangles fills its own moments, which are summed in order so the result
+    // does not depend on the number of threads.
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    uint32_t numChunks = (numTriangles + DENSITY_TRIANGLES_PER_CHUNK - 1) / DENSITY_TRIANGLES_PER_CHUNK;
+    std::vector<PolynomialMoments> chunkMoments(numChunks);
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            uint32_t begin = chunk * DENSITY_TRIANGLES_PER_CHUNK;
+            uint32_t end = (numTriangles - begin > DENSITY_TRIANGLES_PER_CHUNK) ? begin + DENSITY_TRIANGLES_PER_CHUNK : numTriangles;
+            PolynomialMoments& chunkMoment = chunkMoments[chunk];
+            for (uint32_t t = begin; t < end; ++t) {
+                const uint32_t* triangle = &triangleIndices[3 * t];
+                double corners[3][3];
+                for (uint32_t c = 0; c < 3; ++c) {
+                    assert(triangle[c] < numPoints);
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        corners[c][k] = (double)points[triangle[c]][k] - reference[k];
+                    }
+                }
+                const double* a = corners[0];
+                const double* b = corners[1];
+                const double* c = corners[2];
+                double det = a[0] * (b[1] * c[2] - b[2] * c[1])
+                    + a[1] * (b[2] * c[0] - b[0] * c[2])
+                    + a[2] * (b[0] * c[1] - b[1] * c[0]);
+                for (uint32_t q = 0; q < NUM_KEAST_POINTS; ++q) {
+                    const double* lambda = KEAST_POINTS[q];
+                    double x[3];
+                    for (uint32_t k = 0; k < 3; ++k) {
+                        x[k] = lambda[0] * a[k] + lambda[1] * b[k] + lambda[2] * c[k];
+                    }
+                    chunkMoment.addPoint(KEAST_WEIGHTS[q] * det, x);
+                }
+            }
+        }
+    }, numThreads);
+    PolynomialMoments moments;
+    for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+        moments.add(chunkMoments[chunk]);
+    }
+    moments.symmetrize();
+
+    // contract with the density
+    double mass = constant * moments.m0;
+    double first[3];
+    double second[3][3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        mass += linear[i] * moments.m1[i];
+        first[i] = constant * moments.m1[i];
+        for (uint32_t j = 0; j < 3; ++j) {
+            mass += quadratic[i][j] * moments.m2[i][j];
+            first[i] += linear[j] * moments.m2[i][j];
+            second[i][j] = constant * moments.m2[i][j];
+            for (uint32_t k = 0; k < 3; ++k) {
+                first[i] += quadratic[j][k] * moments.m3[i][j][k];
+                second[i][j] += linear[k] * moments.m3[i][j][k];
+                for (uint32_t l = 0; l < 3; ++l) {
+                    second[i][j] += quadratic[k][l] * moments.m4[i][j][k][l];
+                }
+            }
+        }
     }
 
-    // create some variables to hold temporary results
+    // second moment about the center of mass, then inertia = trace(C) * E - C.  Without mass
+    // there is no center to move to, so the inertia stays about the reference point.
+    double center[3] = { 0.0, 0.0, 0.0 };
+    if (mass != 0.0) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            center[i] = first[i] / mass;
+        }
+    }
+    double secondMoment[3][3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            secondMoment[i][j] = second[i][j] - mass * center[i] * center[j];
+        }
+    }
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+    m_volume = (btScalar)moments.m0;
+    m_mass = (btScalar)mass;
+    for (uint32_t i = 0; i < 3; ++i) {
+        m_centerOfMass[i] = (btScalar)(reference[i] + center[i]);
+        for (uint32_t j = 0; j < 3; ++j) {
+            m_inertia[i][j] = (btScalar)((i == j ? trace : 0.0) - secondMoment[i][j]);
+        }
+    }
+}
+
+// tetrahedra integrated by one thread at a time
+const uint32_t TETRAHEDRA_PER_CHUNK = 8192;
+
+// helper function
+void accumulateTetrahedra(const VectorOfPoints& points, const VectorOfIndices& tetrahedronIndices,
+        const btScalar* densities, uint32_t numThreads, MassPropertiesAccumulator& totals) {
+    // Each chunk fills its own totals, which are summed in order so the result does not depend
+    // on the number of threads.
     uint32_t numPoints = points.size();
-    const btVector3 p0(0.0f, 0.0f, 0.0f);
-    btMatrix3x3 tetraInertia;
-    btMatrix3x3 doubleDebugInertia;
-    btVector3 tetraPoints[4];
-    btVector3 center;
+    uint32_t numTetrahedra = tetrahedronIndices.size() / 4;
+    uint32_t numChunks = (numTetrahedra + TETRAHEDRA_PER_CHUNK - 1) / TETRAHEDRA_PER_CHUNK;
+    std::vector<MassPropertiesAccumulator> chunkTotals(numChunks);
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            uint32_t begin = chunk * TETRAHEDRA_PER_CHUNK;
+            uint32_t end = (numTetrahedra - begin > TETRAHEDRA_PER_CHUNK) ? begin + TETRAHEDRA_PER_CHUNK : numTetrahedra;
+            MassPropertiesAccumulator& chunkTotal = chunkTotals[chunk];
+            for (uint32_t i = begin; i < end; ++i) {
+                const uint32_t* tetrahedron = &tetrahedronIndices[4 * i];
+                btVector3 tetraPoints[4];
+                for (uint32_t k = 0; k < 4; ++k) {
+                    assert(tetrahedron[k] < numPoints);
+                    tetraPoints[k] = points[tetrahedron[k]];
+                }
+                chunkTotal.addTetrahedron(tetraPoints, densities ? densities[i] : 1.0f);
+            }
+        }
+    }, numThreads);
+    for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+        totals.addTotals(chunkTotals[chunk]);
+    }
+}
 
-    // loop over triangles
+void MeshMassProperties::computeMassPropertiesOfTetrahedra(const VectorOfPoints& points,
+        const VectorOfIndices& tetrahedronIndices, uint32_t numThreads) {
+    MassPropertiesAccumulator totals;
+    accumulateTetrahedra(points, tetrahedronIndices, nullptr, numThreads, totals);
+    totals.getMassProperties(*this);
+}
+
+void MeshMassProperties::computeMassPropertiesOfTetrahedra(const VectorOfPoints& points,
+        const VectorOfIndices& tetrahedronIndices, const std::vector<btScalar>& densities, uint32_t numThreads) {
+    assert(densities.size() >= tetrahedronIndices.size() / 4);
+    MassPropertiesAccumulator totals;
+    accumulateTetrahedra(points, tetrahedronIndices, densities.data(), numThreads, totals);
+    totals.getMassProperties(*this);
+}
+
+// helper function
+inline double roundingErrorBound(double numOperations) {
+    // bound on the relative error accumulated by a chain of numOperations rounded double operations
+    const double UNIT_ROUNDOFF = 0.5 * DBL_EPSILON;
+    return (numOperations * UNIT_ROUNDOFF) / (1.0 - numOperations * UNIT_ROUNDOFF);
+}
+
+// helper function
+inline btScalar roundUpToScalar(double value) {
+    btScalar rounded = (btScalar)value;
+    if ((double)rounded < value) {
+        rounded = std::nextafter(rounded, std::numeric_limits<btScalar>::infinity());
+    }
+    return rounded;
+}
+
+void MeshMassProperties::computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        MassPropertiesErrorBounds& bounds) {
+    // The results come from the usual pass.  To bound their error we integrate again in double
+    // using the compact form of the tetrahedron integrals (det = a.dot(b.cross(c)), s = a + b + c):
+    //
+    //     6 * volume          = sum(det)
+    //     24 * first moment   = sum(det * s)
+    //     120 * second moment = sum(det * (a a^T + b b^T + c c^T + s s^T))
+    //
+    // Next to each sum we keep the same sum evaluated on absolute values with every subtraction
+    // turned into an addition.  The standard forward error result for a polynomial evaluated
+    // with at most k roundings along any path is |error| <= roundingErrorBound(k) * (absolute sum), so these
+    // give rigorous bounds on the double sums.  The bounds are carried through the final
+    // division and center of mass shift to first order, then the distance between the usual
+    // results and the double results is added on top.
+    computeMassProperties(points, triangleIndices);
+
+    uint32_t numPoints = points.size();
     uint32_t numTriangles = triangleIndices.size() / 3;
+    const uint32_t ROW[6] = { 0, 1, 2, 0, 0, 1 };
+    const uint32_t COLUMN[6] = { 0, 1, 2, 1, 2, 2 };
+    double det6 = 0.0;
+    double det6Magnitude = 0.0;
+    double first24[3] = { 0.0, 0.0, 0.0 };
+    double first24Magnitude[3] = { 0.0, 0.0, 0.0 };
+    double second120[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+    double second120Magnitude[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
     for (uint32_t i = 0; i < numTriangles; ++i) {
         uint32_t t = 3 * i;
         assert(triangleIndices[t] < numPoints);
         assert(triangleIndices[t + 1] < numPoints);
         assert(triangleIndices[t + 2] < numPoints);
+        const btVector3& p1 = points[triangleIndices[t]];
+        const btVector3& p2 = points[triangleIndices[t + 1]];
+        const btVector3& p3 = points[triangleIndices[t + 2]];
+        double a[3] = { p1[0], p1[1], p1[2] };
+        double b[3] = { p2[0], p2[1], p2[2] };
+        double c[3] = { p3[0], p3[1], p3[2] };
 
-        // extract raw vertices
-        tetraPoints[0] = p0;
-        tetraPoints[1] = points[triangleIndices[t]];
-        tetraPoints[2] = points[triangleIndices[t + 1]];
-        tetraPoints[3] = points[triangleIndices[t + 2]];
+        double det = a[0] * (b[1] * c[2] - b[2] * c[1])
+            + a[1] * (b[2] * c[0] - b[0] * c[2])
+            + a[2] * (b[0] * c[1] - b[1] * c[0]);
+        double detMagnitude = fabs(a[0]) * (fabs(b[1] * c[2]) + fabs(b[2] * c[1]))
+            + fabs(a[1]) * (fabs(b[2] * c[0]) + fabs(b[0] * c[2]))
+            + fabs(a[2]) * (fabs(b[0] * c[1]) + fabs(b[1] * c[0]));
+        double s[3];
+        double sMagnitude[3];
+        for (uint32_t k = 0; k < 3; ++k) {
+            s[k] = a[k] + b[k] + c[k];
+            sMagnitude[k] = fabs(a[k]) + fabs(b[k]) + fabs(c[k]);
+        }
 
-        // compute volume
-        btScalar volume = computeTetrahedronVolume(tetraPoints);
+        det6 += det;
+        det6Magnitude += detMagnitude;
+        for (uint32_t k = 0; k < 3; ++k) {
+            first24[k] += det * s[k];
+            first24Magnitude[k] += detMagnitude * sMagnitude[k];
+        }
+        for (uint32_t k = 0; k < 6; ++k) {
+            uint32_t row = ROW[k];
+            uint32_t column = COLUMN[k];
+            double bracket = a[row] * a[column] + b[row] * b[column] + c[row] * c[column] + s[row] * s[column];
+            double bracketMagnitude = fabs(a[row] * a[column]) + fabs(b[row] * b[column])
+                + fabs(c[row] * c[column]) + sMagnitude[row] * sMagnitude[column];
+            second120[k] += det * bracket;
+            second120Magnitude[k] += detMagnitude * bracketMagnitude;
+        }
+    }
 
-        // compute center
-        // NOTE: since tetraPoints[0] is the origin, we don't include it in the sum
-        center = 0.25f * (tetraPoints[1] + tetraPoints[2] + tetraPoints[3]);
+    // Roundings along the longest path: 5 for det, 6 for det * s, 7 for det * bracket, plus
+    // numTriangles for the running sums.  The factor of two covers the rounding of the
+    // magnitude sums themselves.
+    double det6Error = 2.0 * roundingErrorBound(5.0 + numTriangles) * det6Magnitude;
+    double first24Error[3];
+    for (uint32_t k = 0; k < 3; ++k) {
+        first24Error[k] = 2.0 * roundingErrorBound(6.0 + numTriangles) * first24Magnitude[k];
+    }
 
-        // shift vertices so that center of mass is at origin
-        tetraPoints[0] -= center;
-        tetraPoints[1] -= center;
-        tetraPoints[2] -= center;
-        tetraPoints[3] -= center;
+    double volume = det6 / 6.0;
+    bounds.m_volume = roundUpToScalar(fabs((double)m_volume - volume) + det6Error / 6.0 + roundingErrorBound(1.0) * fabs(volume));
+    if (fabs(det6) <= det6Error) {
+        // the sign of the volume is in doubt, so nothing derived from it can be bounded
+        btScalar infinity = std::numeric_limits<btScalar>::infinity();
+        bounds.m_centerOfMass = btVector3(infinity, infinity, infinity);
+        bounds.m_inertia = btMatrix3x3(infinity, infinity, infinity, infinity, infinity, infinity, infinity, infinity, infinity);
+        return;
+    }
 
-        // compute inertia tensor then shift it to origin-frame
-        computeTetrahedronInertia(volume, tetraPoints, tetraInertia);
-        applyParallelAxisTheorem(tetraInertia, center, volume);
+    // Dividing by the smallest magnitude the exact det6 can have keeps the propagated errors
+    // upper bounds rather than first-order estimates.
+    double minDet6 = fabs(det6) - det6Error;
 
-        // tally results
-        weightedCenter += volume * center;
-        m_volume += volume;
-        m_inertia += tetraInertia;
+    // center of mass = first24 / (4 * det6)
+    for (uint32_t k = 0; k < 3; ++k) {
+        double center = first24[k] / (4.0 * det6);
+        double error = (first24Error[k] + 4.0 * fabs(center) * det6Error) / (4.0 * minDet6) + roundingErrorBound(2.0) * fabs(center);
+        bounds.m_centerOfMass[k] = roundUpToScalar(fabs((double)m_centerOfMass[k] - center) + error);
     }
 
-    m_centerOfMass = weightedCenter / m_volume;
+    // second moment about the center of mass = second120 / 120 - first24 first24^T / (96 * det6)
+    double secondMoment[3][3];
+    double secondMomentError[3][3];
+    for (uint32_t k = 0; k < 6; ++k) {
+        uint32_t row = ROW[k];
+        uint32_t column = COLUMN[k];
+        double origin = second120[k] / 120.0;
+        double shift = first24[row] * first24[column] / (96.0 * det6);
+        double shiftError = (fabs(first24[column]) * first24Error[row] + fabs(first24[row]) * first24Error[column]
+            + first24Error[row] * first24Error[column] + 96.0 * fabs(shift) * det6Error) / (96.0 * minDet6);
+        double error = 2.0 * roundingErrorBound(7.0 + numTriangles) * second120Magnitude[k] / 120.0 + shiftError
+            + roundingErrorBound(4.0) * (fabs(origin) + fabs(shift));
+        secondMoment[row][column] = secondMoment[column][row] = origin - shift;
+        secondMomentError[row][column] = secondMomentError[column][row] = error;
+    }
 
-    applyInverseParallelAxisTheorem(m_inertia, m_centerOfMass, m_volume);
+    // inertia = trace(secondMoment) * E - secondMoment
+    for (uint32_t i = 0; i < 3; ++i) {
+        uint32_t j = (i + 1) % 3;
+        uint32_t k = (j + 1) % 3;
+        double inertia = secondMoment[j][j] + secondMoment[k][k];
+        double error = secondMomentError[j][j] + secondMomentError[k][k] + roundingErrorBound(1.0) * fabs(inertia);
+        bounds.m_inertia[i][i] = roundUpToScalar(fabs((double)m_inertia[i][i] - inertia) + error);
+        bounds.m_inertia[j][k] = roundUpToScalar(fabs((double)m_inertia[j][k] + secondMoment[j][k]) + secondMomentError[j][k]);
+        bounds.m_inertia[k][j] = roundUpToScalar(fabs((double)m_inertia[k][j] + secondMoment[k][j]) + secondMomentError[k][j]);
+    }
 }
 
+void MeshMassProperties::computeMassProperties(const QuantizedPoints& points, const VectorOfIndices& triangleIndices) {
+    // The mesh is integrated in the integer frame of the quantized coordinates, converting
+    // each coordinate to btScalar only as it is loaded.  The scale and offset are an affine
+    // map, so they are applied once to the final result rather than to every point.
+    MassPropertiesAccumulator totals;
+    const int16_t* coords = points.m_coords.data();
+    uint32_t numPoints = points.size();
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t t = 3 * i;
+        assert(triangleIndices[t] < numPoints);
+        assert(triangleIndices[t + 1] < numPoints);
+        assert(triangleIndices[t + 2] < numPoints);
+        const int16_t* q1 = coords + 3 * triangleIndices[t];
+        const int16_t* q2 = coords + 3 * triangleIndices[t + 1];
+        const int16_t* q3 = coords + 3 * triangleIndices[t + 2];
+        totals.addTriangle(btVector3(q1[0], q1[1], q1[2]), btVector3(q2[0], q2[1], q2[2]), btVector3(q3[0], q3[1], q3[2]));
+    }
+    totals.getMassProperties(*this);
+
+    const btScalar INVERSE_SNORM16_MAX = 1.0f / 32767.0f;
+    btVector3 scale = INVERSE_SNORM16_MAX * points.m_scale;
+    btMatrix3x3 linear(
+        scale[0], 0.0f, 0.0f,
+        0.0f, scale[1], 0.0f,
+        0.0f, 0.0f, scale[2]);
+    transformMassProperties(*this, linear, points.m_offset);
+
+    // transformMassProperties() treats a mirror as moving a solid, but a negative scale here also
+    // mirrors the triangles, which turns the mesh inside-out just as for the dequantized points
+    if (scale[0] * scale[1] * scale[2] < 0.0f) {
+        m_volume = -m_volume;
+        m_mass = -m_mass;
+        for (uint32_t i = 0; i < 3; ++i) {
+            m_inertia[i] = -m_inertia[i];
+        }
+    }
+}
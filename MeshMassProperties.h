@@ -14,6 +14,7 @@
 
 typedef std::vector<btVector3> VectorOfPoints;
 typedef std::vector<uint32_t> VectorOfIndices;
+typedef std::vector<int8_t> VectorOfSigns;
 
 #define EXPOSE_HELPER_FUNCTIONS_FOR_UNIT_TEST
 #ifdef EXPOSE_HELPER_FUNCTIONS_FOR_UNIT_TEST
@@ -30,16 +31,78 @@ btScalar computeTetrahedronVolume(btVector3* points);
 void applyParallelAxisTheorem(btMatrix3x3& inertia, const btVector3& shift, btScalar mass);
 #endif // EXPOSE_HELPER_FUNCTIONS_FOR_UNIT_TEST
 
+// Index value that ends one triangle strip or fan and starts the next
+const uint32_t PRIMITIVE_RESTART_INDEX = 0xffffffff;
+
+// Points stored as signed normalized 16-bit integers, 6 bytes per point instead of the 16 of
+// btVector3.  Point i is m_scale * (q / 32767) + m_offset, where q holds the i'th triple of
+// m_coords.
+struct QuantizedPoints {
+    std::vector<int16_t> m_coords;  // x, y, z per point
+    btVector3 m_scale = btVector3(1.0f, 1.0f, 1.0f);
+    btVector3 m_offset = btVector3(0.0f, 0.0f, 0.0f);
+
+    uint32_t size() const { return m_coords.size() / 3; }
+};
+
+// Topology problems found by the validating variant of computeMassProperties().  The mass
+// properties are only meaningful when the mesh is closed and consistently wound, which is
+// when all three edge counts are zero.
+struct MeshTopologyReport {
+    uint32_t m_numBoundaryEdges = 0;        // edges used by only one triangle
+    uint32_t m_numNonManifoldEdges = 0;     // edges shared by more than two triangles
+    uint32_t m_numMisorientedEdges = 0;     // edges whose two triangles traverse it in the same direction
+    VectorOfIndices m_flippedTriangles;     // triangles wound opposite to most of their neighbors
+
+    bool isClosedAndConsistent() const {
+        return m_numBoundaryEdges == 0 && m_numNonManifoldEdges == 0 && m_numMisorientedEdges == 0;
+    }
+};
+
+// Upper bounds on the absolute error of each component of the results of the bounded variant
+// of computeMassProperties(), i.e. |m_volume - exact volume| <= bounds.m_volume and likewise
+// per component for the center of mass and inertia.  Large bounds mark meshes (typically big
+// or far from the origin) whose results deserve a more precise path.
+struct MassPropertiesErrorBounds {
+    btScalar m_volume = 0.0f;
+    btVector3 m_centerOfMass = btVector3(0.0f, 0.0f, 0.0f);
+    btMatrix3x3 m_inertia = btMatrix3x3(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// Density that varies with position as a polynomial of degree two or less:
+//
+//     density(x) = m_constant + m_linear.dot(x) + x^T * m_quadratic * x
+//
+// with x in the frame of the mesh points.  Only the symmetric part of m_quadratic matters.
+struct DensityPolynomial {
+    btScalar m_constant = 1.0f;
+    btVector3 m_linear = btVector3(0.0f, 0.0f, 0.0f);
+    btMatrix3x3 m_quadratic = btMatrix3x3(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// Works out a consistent winding for each connected component of the mesh, oriented such that
+// the component has positive volume.  On return signs[i] is -1 if triangle i must be reversed
+// and +1 otherwise.  Returns the number of triangles to reverse.
+uint32_t computeOrientationSigns(const VectorOfPoints& points, const VectorOfIndices& triangleIndices, VectorOfSigns& signs);
+
+// Reverses, in place, the triangles whose sign is negative.
+void applyOrientationSigns(const VectorOfSigns& signs, VectorOfIndices& triangleIndices);
+
 // Given a closed mesh with right-hand triangles a MeshMassProperties instance will compute
 // its mass properties:
 //
 // volume
+// mass (equal to the volume unless per-tetrahedron densities were supplied)
 // center-of-mass
-// normalized interia tensor about center of mass
+// interia tensor about center of mass (normalized to unit density unless densities were supplied)
 //
 class MeshMassProperties {
 public:
 
+    // the default instance holds placeholder values (unit volume, identity inertia) until
+    // computeMassProperties() is called
+    MeshMassProperties() {}
+
     // the mass properties calculation is done in the constructor, so if the mesh is complex
     // then the construction could be computationally expensive.
     MeshMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices);
@@ -47,10 +110,120 @@ public:
     // compute the mass properties of a new mesh
     void computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices);
 
+    // compute the mass properties of a new mesh and validate its topology in the same pass
+    void computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            MeshTopologyReport& report);
+
+    // compute the mass properties of a new mesh, reversing triangles with negative sign
+    // (see computeOrientationSigns())
+    void computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            const VectorOfSigns& triangleSigns);
+
+    // Compute the mass properties of a new mesh given as triangle strips, each ended by
+    // restartIndex.  Winding alternates along a strip as in OpenGL: the first triangle sets the
+    // orientation for the strip.
+    void computeMassPropertiesOfStrips(const VectorOfPoints& points, const VectorOfIndices& stripIndices,
+            uint32_t restartIndex = PRIMITIVE_RESTART_INDEX);
+
+    // compute the mass properties of a new mesh given as triangle fans about the first point of
+    // each fan, each ended by restartIndex
+    void computeMassPropertiesOfFans(const VectorOfPoints& points, const VectorOfIndices& fanIndices,
+            uint32_t restartIndex = PRIMITIVE_RESTART_INDEX);
+
+    // Compute the mass properties of a new mesh of planar polygons, right-hand wound.  Face i
+    // has faceSizes[i] points whose indices follow those of face i - 1 in faceIndices.  Each
+    // polygon is integrated as a fan about its first point.
+    void computeMassPropertiesOfPolygons(const VectorOfPoints& points, const VectorOfIndices& faceSizes,
+            const VectorOfIndices& faceIndices);
+
+    // Compute the mass properties of a new mesh whose material has the given density field.
+    // m_volume stays the geometric volume; m_mass, the center of mass and the inertia follow
+    // the density.  With zero total mass the center is reported at the centroid of the points,
+    // with the inertia about it.  Piecewise fields (e.g. one polynomial per region) can be
+    // handled by computing each region separately and combining them with
+    // MassPropertiesAccumulator.  Triangles are spread over numThreads threads (0 = one per
+    // hardware core) and the result does not depend on their number.
+    void computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            const DensityPolynomial& density, uint32_t numThreads = 0);
+
+    // compute the mass properties of a new mesh together with bounds on their error
+    void computeMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            MassPropertiesErrorBounds& bounds);
+
+    // compute the mass properties of a new mesh with quantized points; as with the dequantized
+    // points, an odd number of negative m_scale components leaves the volume negative
+    void computeMassProperties(const QuantizedPoints& points, const VectorOfIndices& triangleIndices);
+
+    // Compute the mass properties of a new mesh bit-for-bit reproducibly across compilers and
+    // CPUs.  Points are snapped to a grid with spacing gridSize and the volume and moments are
+    // summed exactly in 128-bit integers, so the result does not depend on triangle order or
+    // floating point evaluation.  Snapped coordinates must lie within 2^18 cells of the origin;
+    // returns false (leaving the previous results untouched) otherwise.  A mesh that encloses no
+    // volume gets zero mass and inertia, centered on the snapped mean of its points.
+    bool computeDeterministicMassProperties(const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+            btScalar gridSize);
+
+    // compute the mass properties of a new mesh as if each of its holes were closed by a flat
+    // fan of triangles about the centroid of the hole's boundary loop.  Returns the number of
+    // holes that were capped.
+    uint32_t computeMassPropertiesWithCappedHoles(const VectorOfPoints& points, const VectorOfIndices& triangleIndices);
+
+    // Compute the mass properties of a solid tetrahedral mesh with four point indices per
+    // tetrahedron, in either winding.  Tetrahedra are split over numThreads threads (0 = one
+    // per hardware core).
+    void computeMassPropertiesOfTetrahedra(const VectorOfPoints& points, const VectorOfIndices& tetrahedronIndices,
+            uint32_t numThreads = 0);
+
+    // same, with one density per tetrahedron: m_mass, the center of mass and the inertia then
+    // account for the materials while m_volume stays the geometric volume
+    void computeMassPropertiesOfTetrahedra(const VectorOfPoints& points, const VectorOfIndices& tetrahedronIndices,
+            const std::vector<btScalar>& densities, uint32_t numThreads = 0);
+
     // harvest the mass properties from these public data members
     btScalar m_volume = 1.0;
+    btScalar m_mass = 1.0;
     btVector3 m_centerOfMass = btVector3(0.0, 0.0, 0.0);
     btMatrix3x3 m_inertia = btMatrix3x3(1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0);
 };
 
+// Running totals for integrating a closed surface one triangle at a time.  This is the engine
+// behind MeshMassProperties, exposed for input that is not in VectorOfPoints/VectorOfIndices
+// form (e.g. streamed straight from a file).  Triangles may be added in any order; each adds
+// the tetrahedron it forms with the origin.
+class MassPropertiesAccumulator {
+public:
+    MassPropertiesAccumulator() { clear(); }
+
+    void clear();
+
+    // add a triangle wound according to the right-hand-rule
+    void addTriangle(const btVector3& p1, const btVector3& p2, const btVector3& p3);
+
+    // add a solid tetrahedron of the given density, in either winding
+    void addTetrahedron(const btVector3* points, btScalar density = 1.0f);
+
+    // add a whole body, e.g. one part of a compound, expressed in the accumulation frame
+    void addMassProperties(const MeshMassProperties& body);
+
+    // add the running totals of another accumulator, e.g. one that integrated part of the
+    // same mesh on another thread
+    void addTotals(const MassPropertiesAccumulator& other);
+
+    // Harvest the mass properties of everything added so far.  With zero total mass (e.g. a
+    // flat or empty mesh) the center of mass is undefined; it is reported as the origin, with
+    // the inertia about the origin.
+    void getMassProperties(MeshMassProperties& result) const;
+
+    btScalar m_volume;
+    btScalar m_mass;
+    btVector3 m_weightedCenter;     // mass-weighted sum of tetrahedron centers
+    btMatrix3x3 m_inertia;          // about the origin
+};
+
+// Maps mass properties through the affine transform x' = linear * x + translation, which may
+// rotate, scale, shear, or mirror.  Density is held fixed, so the volume, mass and inertia
+// scale by |det(linear)|.  This is exact and much cheaper than transforming the
+// vertices and integrating again.
+void transformMassProperties(MeshMassProperties& properties, const btMatrix3x3& linear, const btVector3& translation);
+
 #endif // MESH_MASS_PROPERTIES_H
@@ -7,9 +7,34 @@
 // Written by Andrew Meadows, 2015.05.24 for the public domain.  Feel free to relicense.
 //
 
+#include <float.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <thread>
 
+#include "ConvexHull.h"
+#include "GltfMeshLoader.h"
+#include "MassPropertiesCache.h"
 #include "MeshMassProperties.h"
+#include "MeshSequenceMassProperties.h"
+#include "MeshWelding.h"
+#include "MorphMassProperties.h"
+#include "ObjMeshLoader.h"
+#include "ParallelFor.h"
+#include "PlyMeshLoader.h"
+#include "PointMassProperties.h"
+#include "PrimitiveMassProperties.h"
+#include "SdfMassProperties.h"
+#include "SkinnedMassProperties.h"
+#include "StlMeshLoader.h"
+#include "VoxelMassProperties.h"
 #include "MeshInfoTests.h"
 
 #define EXPOSE_HELPER_FUNCTIONS_FOR_UNIT_TEST
@@ -432,11 +457,2466 @@ void MeshInfoTests::testBoxAsMesh() {
 #endif // VERBOSE_UNIT_TESTS
 }
 
+// helper function
+void buildBoxMesh(btScalar x, btScalar y, btScalar z, VectorOfPoints& points, VectorOfIndices& triangles) {
+    // same box as testBoxAsMesh(): one corner at the origin, the other at <x, y, z>
+    points.clear();
+    points.push_back(btVector3(0.0f, 0.0f, 0.0f));
+    points.push_back(btVector3(x, 0.0f, 0.0f));
+    points.push_back(btVector3(0.0f, y, 0.0f));
+    points.push_back(btVector3(x, y, 0.0f));
+    points.push_back(btVector3(0.0f, 0.0f, z));
+    points.push_back(btVector3(x, 0.0f, z));
+    points.push_back(btVector3(0.0f, y, z));
+    points.push_back(btVector3(x, y, z));
+
+    triangles = {
+        0, 1, 4,
+        1, 5, 4,
+        1, 3, 5,
+        3, 7, 5,
+        2, 0, 6,
+        0, 4, 6,
+        3, 2, 7,
+        2, 6, 7,
+        4, 5, 6,
+        5, 7, 6,
+        0, 2, 1,
+        2, 3, 1
+    };
+}
+
+void MeshInfoTests::testMeshTopology() {
+    // verify the validating variant of computeMassProperties() finds open edges and
+    // inconsistent winding without disturbing the mass properties
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+
+    // (a) closed box
+    MeshMassProperties mesh(points, triangles);
+    btScalar expectedVolume = mesh.m_volume;
+    MeshTopologyReport report;
+    mesh.computeMassProperties(points, triangles, report);
+    if (!report.isClosedAndConsistent() || !report.m_flippedTriangles.empty()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : closed box reported as bad topology" << std::endl;
+    }
+    btScalar error = (mesh.m_volume - expectedVolume) / expectedVolume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of box off by = " << error << std::endl;
+    }
+
+    // (b) flip one triangle
+    const uint32_t flippedTriangle = 7;
+    VectorOfIndices badTriangles = triangles;
+    std::swap(badTriangles[3 * flippedTriangle + 1], badTriangles[3 * flippedTriangle + 2]);
+    mesh.computeMassProperties(points, badTriangles, report);
+    if (report.m_numMisorientedEdges != 3 || report.m_numBoundaryEdges != 0 || report.m_numNonManifoldEdges != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : flipped triangle not detected, misoriented edges = "
+            << report.m_numMisorientedEdges << std::endl;
+    }
+    if (report.m_flippedTriangles.size() != 1 || report.m_flippedTriangles[0] != flippedTriangle) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : wrong flipped triangles, count = "
+            << report.m_flippedTriangles.size() << std::endl;
+    }
+
+    // (c) remove one triangle
+    VectorOfIndices openTriangles(triangles.begin(), triangles.end() - 3);
+    mesh.computeMassProperties(points, openTriangles, report);
+    if (report.m_numBoundaryEdges != 3 || report.m_numMisorientedEdges != 0 || report.m_numNonManifoldEdges != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : open mesh not detected, boundary edges = "
+            << report.m_numBoundaryEdges << std::endl;
+    }
+
+    // (d) add a fin on edge {0, 1}: that edge now has three triangles and the fin's other two
+    // edges are open
+    VectorOfPoints finPoints = points;
+    finPoints.push_back(btVector3(2.5f, -4.0f, 1.0f));
+    VectorOfIndices finTriangles = triangles;
+    finTriangles.push_back(0);
+    finTriangles.push_back(8);
+    finTriangles.push_back(1);
+    mesh.computeMassProperties(finPoints, finTriangles, report);
+    if (report.m_numNonManifoldEdges != 1 || report.m_numBoundaryEdges != 2 || report.m_numMisorientedEdges != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : non-manifold edge not detected, non-manifold edges = "
+            << report.m_numNonManifoldEdges << "  boundary edges = " << report.m_numBoundaryEdges << std::endl;
+    }
+
+    // (e) enough separate boxes that the edge sort splits into several chunks and every digit
+    // of the keys varies; one box is missing a triangle
+    const uint32_t NUM_BOXES = 10000;
+    VectorOfPoints manyPoints;
+    VectorOfIndices manyTriangles;
+    for (uint32_t box = 0; box < NUM_BOXES; ++box) {
+        uint32_t base = manyPoints.size();
+        btVector3 shift(7.0f * (btScalar)(box % 100), 7.0f * (btScalar)(box / 100), 0.0f);
+        for (const btVector3& point : points) {
+            manyPoints.push_back(point + shift);
+        }
+        uint32_t numIndices = (box == NUM_BOXES / 2) ? triangles.size() - 3 : triangles.size();
+        for (uint32_t i = 0; i < numIndices; ++i) {
+            manyTriangles.push_back(triangles[i] + base);
+        }
+    }
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    mesh.computeMassProperties(manyPoints, manyTriangles, report);
+    setDefaultTaskExecutor(nullptr);
+    if (report.m_numBoundaryEdges != 3 || report.m_numMisorientedEdges != 0 || report.m_numNonManifoldEdges != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : many boxes misclassified, boundary edges = "
+            << report.m_numBoundaryEdges << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "boundary edges = " << report.m_numBoundaryEdges << std::endl;
+    std::cout << "non-manifold edges = " << report.m_numNonManifoldEdges << std::endl;
+    std::cout << "misoriented edges = " << report.m_numMisorientedEdges << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testOrientationRepair() {
+    // verify computeOrientationSigns() repairs a mesh of two boxes where one box is inside-out
+    // and the other has a few flipped triangles
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    btScalar x(5.0f);
+    btScalar y(3.0f);
+    btScalar z(2.0f);
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(x, y, z, points, triangles);
+    MeshMassProperties expectedMesh(points, triangles);
+
+    // second box is a copy of the first, shifted and reversed
+    btVector3 shift(10.0f, 0.0f, 0.0f);
+    uint32_t numBoxPoints = points.size();
+    uint32_t numBoxIndices = triangles.size();
+    for (uint32_t i = 0; i < numBoxPoints; ++i) {
+        points.push_back(points[i] + shift);
+    }
+    for (uint32_t i = 0; i < numBoxIndices; i += 3) {
+        triangles.push_back(triangles[i] + numBoxPoints);
+        triangles.push_back(triangles[i + 2] + numBoxPoints);
+        triangles.push_back(triangles[i + 1] + numBoxPoints);
+    }
+
+    // flip two triangles of the first box
+    std::swap(triangles[4], triangles[5]);
+    std::swap(triangles[19], triangles[20]);
+
+    btScalar expectedVolume = 2.0f * expectedMesh.m_volume;
+    btVector3 expectedCenterOfMass = expectedMesh.m_centerOfMass + 0.5f * shift;
+
+    VectorOfSigns signs;
+    uint32_t numFlipped = computeOrientationSigns(points, triangles, signs);
+    if (numFlipped != 12 + 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : expected 14 flipped triangles but found "
+            << numFlipped << std::endl;
+    }
+
+    MeshMassProperties mesh(points, triangles);
+    mesh.computeMassProperties(points, triangles, signs);
+    btScalar error = (mesh.m_volume - expectedVolume) / expectedVolume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of repaired mesh off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedCenterOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass of repaired mesh off by = " << error << std::endl;
+    }
+
+    // the repaired index buffer should validate cleanly
+    applyOrientationSigns(signs, triangles);
+    MeshTopologyReport report;
+    mesh.computeMassProperties(points, triangles, report);
+    if (!report.isClosedAndConsistent()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : repaired mesh still inconsistent" << std::endl;
+    }
+    error = (mesh.m_volume - expectedVolume) / expectedVolume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of repaired index buffer off by = " << error << std::endl;
+    }
+
+    // enough boxes that the union-find is split into several chunks; each box has half of its
+    // triangles in the first half of the buffer and half in the second so that some pairs
+    // cross chunks.  Odd boxes are inside-out and every tenth box has one flipped triangle.
+    const uint32_t NUM_BOXES = 6000;
+    VectorOfPoints boxPoints;
+    VectorOfIndices boxTriangles;
+    buildBoxMesh(x, y, z, boxPoints, boxTriangles);
+    VectorOfPoints manyPoints;
+    VectorOfIndices manyTriangles(NUM_BOXES * boxTriangles.size());
+    uint32_t expectedNumFlipped = 0;
+    uint32_t halfBox = boxTriangles.size() / 2;
+    for (uint32_t box = 0; box < NUM_BOXES; ++box) {
+        uint32_t base = manyPoints.size();
+        btVector3 boxShift(7.0f * (btScalar)(box % 100), 7.0f * (btScalar)(box / 100), 0.0f);
+        for (const btVector3& point : boxPoints) {
+            manyPoints.push_back(point + boxShift);
+        }
+        for (uint32_t i = 0; i < boxTriangles.size(); i += 3) {
+            uint32_t target = (i < halfBox) ? box * halfBox + i : (NUM_BOXES + box) * halfBox + (i - halfBox);
+            bool reversed = (box % 2 == 1) != (box % 10 == 0 && i == 3);
+            manyTriangles[target] = boxTriangles[i] + base;
+            manyTriangles[target + 1] = boxTriangles[reversed ? i + 2 : i + 1] + base;
+            manyTriangles[target + 2] = boxTriangles[reversed ? i + 1 : i + 2] + base;
+        }
+        expectedNumFlipped += (box % 2 == 1) ? 12 : ((box % 10 == 0) ? 1 : 0);
+    }
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    numFlipped = computeOrientationSigns(manyPoints, manyTriangles, signs);
+    setDefaultTaskExecutor(nullptr);
+    if (numFlipped != expectedNumFlipped) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : expected " << expectedNumFlipped
+            << " flipped triangles in many boxes but found " << numFlipped << std::endl;
+    }
+    applyOrientationSigns(signs, manyTriangles);
+    mesh.computeMassProperties(manyPoints, manyTriangles, report);
+    if (!report.isClosedAndConsistent()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : repaired boxes still inconsistent" << std::endl;
+    }
+    // single precision sums over this many triangles drift more than the usual tolerance
+    error = (mesh.m_volume - NUM_BOXES * x * y * z) / (NUM_BOXES * x * y * z);
+    if (fabsf(error) > 1.0e-3f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of repaired boxes off by = " << error << std::endl;
+    }
+
+    // A long Moebius strip cannot be oriented, so some edge must contradict the others; which
+    // one is dropped must not depend on how many threads did the work.  Its triangles are
+    // scattered through the list so that many shared edges cross chunks.
+    const uint32_t NUM_SEGMENTS = 60000;
+    const uint32_t NUM_STRIP_TRIANGLES = 2 * NUM_SEGMENTS;
+    VectorOfPoints stripPoints;
+    for (uint32_t i = 0; i < NUM_SEGMENTS; ++i) {
+        btScalar angle = 2.0f * SIMD_PI * (btScalar)i / (btScalar)NUM_SEGMENTS;
+        btScalar twist = 0.5f * angle;
+        btVector3 across(cosf(twist) * cosf(angle), cosf(twist) * sinf(angle), sinf(twist));
+        btVector3 middle(100.0f * cosf(angle), 100.0f * sinf(angle), 0.0f);
+        stripPoints.push_back(middle + across);
+        stripPoints.push_back(middle - across);
+    }
+    VectorOfIndices stripTriangles(3 * NUM_STRIP_TRIANGLES);
+    for (uint32_t i = 0; i < NUM_SEGMENTS; ++i) {
+        uint32_t top = 2 * i;
+        uint32_t bottom = 2 * i + 1;
+        // the last segment closes the strip with its two sides swapped
+        uint32_t nextTop = (i + 1 < NUM_SEGMENTS) ? top + 2 : 1;
+        uint32_t nextBottom = (i + 1 < NUM_SEGMENTS) ? bottom + 2 : 0;
+        uint32_t corners[6] = { top, bottom, nextTop, nextTop, bottom, nextBottom };
+        for (uint32_t half = 0; half < 2; ++half) {
+            uint32_t target = 3 * (((2 * i + half) * 7919) % NUM_STRIP_TRIANGLES);
+            stripTriangles[target] = corners[3 * half];
+            stripTriangles[target + 1] = corners[3 * half + 1];
+            stripTriangles[target + 2] = corners[3 * half + 2];
+        }
+    }
+    VectorOfSigns serialSigns;
+    uint32_t serialFlipped = computeOrientationSigns(stripPoints, stripTriangles, serialSigns);
+    const uint32_t NUM_POOL_SIZES = 2;
+    uint32_t poolSizes[NUM_POOL_SIZES] = { 3, 4 };
+    for (uint32_t k = 0; k < NUM_POOL_SIZES; ++k) {
+        ThreadPoolExecutor stripPool(poolSizes[k]);
+        setDefaultTaskExecutor(&stripPool);
+        VectorOfSigns pooledSigns;
+        uint32_t pooledFlipped = computeOrientationSigns(stripPoints, stripTriangles, pooledSigns);
+        setDefaultTaskExecutor(nullptr);
+        if (pooledFlipped != serialFlipped || pooledSigns != serialSigns) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : Moebius strip orientation with " << poolSizes[k]
+                << " threads flipped " << pooledFlipped << " triangles, serial flipped " << serialFlipped << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "flipped triangles = " << numFlipped << std::endl;
+    std::cout << "expected volume = " << expectedVolume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testCappedHoles() {
+    // verify a box with its top and bottom faces removed, shifted away from the origin,
+    // produces the same mass properties as the closed box when its holes are capped
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    btVector3 shift(-7.0f, 11.0f, 13.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += shift;
+    }
+    MeshMassProperties expectedMesh(points, triangles);
+
+    // the last four triangles are the top and bottom faces
+    VectorOfIndices openTriangles(triangles.begin(), triangles.end() - 12);
+
+    MeshMassProperties mesh(points, openTriangles);
+    uint32_t numHoles = mesh.computeMassPropertiesWithCappedHoles(points, openTriangles);
+    if (numHoles != 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : expected 2 holes but capped " << numHoles << std::endl;
+    }
+
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of capped mesh off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass of capped mesh off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        error = (mesh.m_inertia[i][i] - expectedMesh.m_inertia[i][i]) / expectedMesh.m_inertia[i][i];
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "capped holes = " << numHoles << std::endl;
+    std::cout << "expected volume = " << expectedMesh.m_volume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+    printMatrix("expected inertia", expectedMesh.m_inertia);
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testWeldTriangleSoup() {
+    // verify a box given as a noisy triangle soup welds back into a closed mesh
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    MeshMassProperties expectedMesh(points, triangles);
+
+    // expand to a soup, jittering each copy of a point by less than the tolerance,
+    // and add one sliver triangle that should collapse
+    const btScalar tolerance = 1.0e-3f;
+    VectorOfPoints soup;
+    for (uint32_t i = 0; i < triangles.size(); ++i) {
+        btScalar jitter = (btScalar)(i % 5) * 0.1f * tolerance;
+        soup.push_back(points[triangles[i]] + btVector3(jitter, -jitter, jitter));
+    }
+    soup.push_back(points[0]);
+    soup.push_back(points[0] + btVector3(0.5f * tolerance, 0.0f, 0.0f));
+    soup.push_back(points[7]);
+
+    VectorOfPoints weldedPoints;
+    VectorOfIndices weldedTriangles;
+    uint32_t numDropped = weldTriangleSoup(soup, tolerance, weldedPoints, weldedTriangles);
+    if (weldedPoints.size() != points.size() || numDropped != 1) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : welded " << weldedPoints.size()
+            << " points and dropped " << numDropped << " triangles" << std::endl;
+    }
+
+    MeshTopologyReport report;
+    MeshMassProperties mesh(weldedPoints, weldedTriangles);
+    mesh.computeMassProperties(weldedPoints, weldedTriangles, report);
+    if (!report.isClosedAndConsistent()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : welded mesh is not closed" << std::endl;
+    }
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > 1.0e-3f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of welded mesh off by = " << error << std::endl;
+    }
+
+    // a soup big enough to be split over threads must weld the same on one thread and on
+    // several; every other box is mirrored through x = 0 so -0.0 and +0.0 both appear
+    VectorOfPoints bigSoup;
+    for (uint32_t box = 0; box < 5000; ++box) {
+        btVector3 shift(0.0f, 6.0f * (btScalar)(box / 2), 0.0f);
+        btScalar mirror = (box % 2) ? -1.0f : 1.0f;
+        for (uint32_t i = 0; i < triangles.size(); ++i) {
+            // mirroring reverses the winding, so swap two corners of those triangles
+            uint32_t corner = (box % 2 && i % 3 != 0) ? i + ((i % 3 == 1) ? 1 : -1) : i;
+            btVector3 point = points[triangles[corner]] + shift;
+            point.setX(mirror * point.x());
+            bigSoup.push_back(point);
+        }
+    }
+    VectorOfPoints serialPoints;
+    VectorOfIndices serialTriangles;
+    weldTriangleSoup(bigSoup, tolerance, serialPoints, serialTriangles, 1);
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    numDropped = weldTriangleSoup(bigSoup, tolerance, weldedPoints, weldedTriangles);
+    setDefaultTaskExecutor(nullptr);
+    if (weldedPoints != serialPoints || weldedTriangles != serialTriangles || numDropped != 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : threaded weld differs from serial weld" << std::endl;
+    }
+    // neighboring box pairs share the face at x = 0
+    if (weldedPoints.size() != 5000 * 6) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : expected " << 5000 * 6 << " welded points but got "
+            << weldedPoints.size() << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "soup points = " << soup.size() << std::endl;
+    std::cout << "welded points = " << weldedPoints.size() << std::endl;
+    std::cout << "expected volume = " << expectedMesh.m_volume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testMassPropertiesCache() {
+    // verify identical meshes hit the cache, different meshes miss, and old entries are evicted
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    VectorOfPoints copyOfPoints = points;
+
+    VectorOfPoints otherPoints;
+    VectorOfIndices otherTriangles;
+    buildBoxMesh(1.0f, 2.0f, 3.0f, otherPoints, otherTriangles);
+
+    MassPropertiesCache cache(1, 1);
+    MeshMassProperties result;
+    bool hits[4];
+    hits[0] = cache.computeMassProperties(points, triangles, result);
+    hits[1] = cache.computeMassProperties(copyOfPoints, triangles, result);
+    hits[2] = cache.computeMassProperties(otherPoints, otherTriangles, result);
+    hits[3] = cache.computeMassProperties(points, triangles, result);
+    if (hits[0] || !hits[1] || hits[2] || hits[3]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : unexpected cache hit pattern" << std::endl;
+    }
+    if (cache.getNumHits() != 1 || cache.getNumMisses() != 3 || cache.getNumEvictions() != 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : wrong cache counters" << std::endl;
+    }
+
+    MeshMassProperties expectedMesh(points, triangles);
+    btScalar error = (result.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of cached result off by = " << error << std::endl;
+    }
+
+    // the check hash that verifies entries comes from the same pass but is seeded independently,
+    // and both hashes see a change to a single coordinate
+    uint64_t hash, checkHash;
+    hashMeshContent(points, triangles, hash, checkHash);
+    copyOfPoints[3].setY(copyOfPoints[3].y() + 0.25f);
+    uint64_t changedHash, changedCheckHash;
+    hashMeshContent(copyOfPoints, triangles, changedHash, changedCheckHash);
+    if (hash != hashMeshContent(points, triangles) || checkHash == hash || changedHash == hash
+            || changedCheckHash == checkHash) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : check hash is not independent of the content hash" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "hits = " << cache.getNumHits() << std::endl;
+    std::cout << "misses = " << cache.getNumMisses() << std::endl;
+    std::cout << "evictions = " << cache.getNumEvictions() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testTransformMassProperties() {
+    // verify transforming mass properties analytically agrees with transforming the mesh,
+    // including a mirroring transform that reverses the winding
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+
+    btMatrix3x3 linear(
+        0.0f, -1.0f, 0.5f,
+        2.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, -1.5f);
+    btVector3 translation(1.0f, -2.0f, 3.0f);
+
+    MeshMassProperties mesh(points, triangles);
+    transformMassProperties(mesh, linear, translation);
+
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] = linear * points[i] + translation;
+    }
+    if (linear.determinant() < 0.0f) {
+        for (uint32_t i = 0; i < triangles.size(); i += 3) {
+            std::swap(triangles[i + 1], triangles[i + 2]);
+        }
+    }
+    MeshMassProperties expectedMesh(points, triangles);
+
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of transformed mesh off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass of transformed mesh off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            error = mesh.m_inertia[i][j] - expectedMesh.m_inertia[i][j];
+            if (fabsf(error) > acceptableRelativeError * fabsf(expectedMesh.m_inertia[i][i]) + acceptableAbsoluteError) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << j << "] off by " << error << std::endl;
+            }
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    printMatrix("expected inertia", expectedMesh.m_inertia);
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testQuantizedPoints() {
+    // verify a box with quantized points, far from the origin, agrees with the analytic box
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    btVector3 shift(100.0f, -20.0f, 7.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += shift;
+    }
+    // NOTE: integrating the float points this far from the origin loses ~0.3% of the inertia
+    // to roundoff, which is why the expected values are analytic
+    MeshMassProperties expectedMesh;
+    expectedMesh.m_volume = 5.0f * 3.0f * 2.0f;
+    expectedMesh.m_centerOfMass = shift + btVector3(2.5f, 1.5f, 1.0f);
+    computeBoxInertia(expectedMesh.m_volume, btVector3(5.0f, 3.0f, 2.0f), expectedMesh.m_inertia);
+
+    // quantize over the bounding box (every corner lands exactly on the grid)
+    QuantizedPoints quantizedPoints;
+    quantizedPoints.m_scale = btVector3(2.5f, 1.5f, 1.0f);
+    quantizedPoints.m_offset = shift + quantizedPoints.m_scale;
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        btVector3 normalized = (points[i] - quantizedPoints.m_offset) / quantizedPoints.m_scale;
+        for (int j = 0; j < 3; ++j) {
+            quantizedPoints.m_coords.push_back((int16_t)lrintf(32767.0f * normalized[j]));
+        }
+    }
+
+    MeshMassProperties mesh;
+    mesh.computeMassProperties(quantizedPoints, triangles);
+
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of quantized mesh off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass of quantized mesh off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        error = (mesh.m_inertia[i][i] - expectedMesh.m_inertia[i][i]) / expectedMesh.m_inertia[i][i];
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+    // a negative scale mirrors the triangles, so the result must match the plain overload on the
+    // dequantized points, inside-out sign included
+    QuantizedPoints mirroredPoints = quantizedPoints;
+    mirroredPoints.m_scale[0] = -mirroredPoints.m_scale[0];
+    VectorOfPoints dequantizedPoints;
+    for (uint32_t i = 0; i < mirroredPoints.size(); ++i) {
+        const int16_t* q = &mirroredPoints.m_coords[3 * i];
+        btVector3 normalized(q[0] / 32767.0f, q[1] / 32767.0f, q[2] / 32767.0f);
+        dequantizedPoints.push_back(mirroredPoints.m_scale * normalized + mirroredPoints.m_offset);
+    }
+    MeshMassProperties mirroredMesh;
+    mirroredMesh.computeMassProperties(mirroredPoints, triangles);
+    MeshMassProperties dequantizedMesh(dequantizedPoints, triangles);
+    if (mirroredMesh.m_volume >= 0.0f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : mirrored quantized mesh has volume " << mirroredMesh.m_volume << std::endl;
+    }
+    error = (mirroredMesh.m_volume - dequantizedMesh.m_volume) / dequantizedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of mirrored quantized mesh off by = " << error << std::endl;
+    }
+    error = (mirroredMesh.m_centerOfMass - dequantizedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass of mirrored quantized mesh off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        // the float integration of the dequantized points loses ~0.3% of the inertia to roundoff
+        error = (mirroredMesh.m_inertia[i][i] - dequantizedMesh.m_inertia[i][i]) / dequantizedMesh.m_inertia[i][i];
+        if (fabsf(error) > 1.0e-2f) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : mirrored inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected volume = " << expectedMesh.m_volume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+    printMatrix("expected inertia", expectedMesh.m_inertia);
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testDeterministicMassProperties() {
+    // verify the fixed-point path matches the analytic box far from the origin and gives
+    // bit-identical results when the triangles are reordered
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    btVector3 shift(1000.0f, -200.0f, 70.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += shift;
+    }
+    MeshMassProperties expectedMesh;
+    expectedMesh.m_volume = 5.0f * 3.0f * 2.0f;
+    expectedMesh.m_centerOfMass = shift + btVector3(2.5f, 1.5f, 1.0f);
+    computeBoxInertia(expectedMesh.m_volume, btVector3(5.0f, 3.0f, 2.0f), expectedMesh.m_inertia);
+
+    const btScalar gridSize = 1.0f / 64.0f;
+    MeshMassProperties mesh;
+    if (!mesh.computeDeterministicMassProperties(points, triangles, gridSize)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : points unexpectedly out of range" << std::endl;
+    }
+
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        error = (mesh.m_inertia[i][i] - expectedMesh.m_inertia[i][i]) / expectedMesh.m_inertia[i][i];
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+    // reverse the triangle order: results must not change by a single bit
+    VectorOfIndices reversedTriangles;
+    for (uint32_t i = triangles.size(); i > 0; i -= 3) {
+        reversedTriangles.push_back(triangles[i - 3]);
+        reversedTriangles.push_back(triangles[i - 2]);
+        reversedTriangles.push_back(triangles[i - 1]);
+    }
+    MeshMassProperties reversedMesh;
+    reversedMesh.computeDeterministicMassProperties(points, reversedTriangles, gridSize);
+    bool identical = reversedMesh.m_volume == mesh.m_volume && reversedMesh.m_centerOfMass == mesh.m_centerOfMass;
+    for (int i = 0; i < 3; ++i) {
+        identical = identical && reversedMesh.m_inertia[i] == mesh.m_inertia[i];
+    }
+    if (!identical) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : results depend on triangle order" << std::endl;
+    }
+
+    // a flattened box and an empty mesh enclose nothing and must stay finite
+    VectorOfPoints flatPoints = points;
+    for (uint32_t i = 0; i < flatPoints.size(); ++i) {
+        flatPoints[i][2] = shift[2];
+    }
+    MeshMassProperties flatMesh;
+    flatMesh.computeDeterministicMassProperties(flatPoints, triangles, gridSize);
+    MeshMassProperties emptyMesh;
+    emptyMesh.computeDeterministicMassProperties(VectorOfPoints(), VectorOfIndices(), gridSize);
+    const MeshMassProperties* degenerate[2] = { &flatMesh, &emptyMesh };
+    for (uint32_t k = 0; k < 2; ++k) {
+        bool finite = std::isfinite(degenerate[k]->m_centerOfMass.length2());
+        for (int i = 0; i < 3; ++i) {
+            finite = finite && degenerate[k]->m_inertia[i].length2() == 0.0f;
+        }
+        if (degenerate[k]->m_volume != 0.0f || degenerate[k]->m_mass != 0.0f || !finite) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : degenerate mesh " << k << " gave volume "
+                << degenerate[k]->m_volume << " and center " << degenerate[k]->m_centerOfMass[0] << std::endl;
+        }
+    }
+    if ((flatMesh.m_centerOfMass - (shift + btVector3(2.5f, 1.5f, 0.0f))).length() > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : flat mesh is not centered on its points" << std::endl;
+    }
+
+    // out of range
+    points[0] = btVector3(1.0e6f, 0.0f, 0.0f);
+    if (mesh.computeDeterministicMassProperties(points, triangles, gridSize)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : out of range point was accepted" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected volume = " << expectedMesh.m_volume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+    printMatrix("expected inertia", expectedMesh.m_inertia);
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testErrorBounds() {
+    // verify the error bounds cover the actual error of a box near to and far from the origin,
+    // and that the far box earns the larger bounds
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    btScalar x(1.3f), y(0.7f), z(2.9f);
+    double volume = (double)x * (double)y * (double)z;
+    btScalar offsets[] = { 0.0f, 4000.0f };
+    btScalar volumeBounds[2];
+    for (uint32_t n = 0; n < 2; ++n) {
+        VectorOfPoints points;
+        VectorOfIndices triangles;
+        buildBoxMesh(x, y, z, points, triangles);
+        btVector3 shift(offsets[n], -0.5f * offsets[n], 0.25f * offsets[n]);
+        for (uint32_t i = 0; i < points.size(); ++i) {
+            points[i] += shift;
+        }
+        btVector3 center = shift + btVector3(0.5f * x, 0.5f * y, 0.5f * z);
+        btMatrix3x3 inertia;
+        computeBoxInertia(volume, btVector3(x, y, z), inertia);
+
+        MeshMassProperties mesh;
+        MassPropertiesErrorBounds bounds;
+        mesh.computeMassProperties(points, triangles, bounds);
+        volumeBounds[n] = bounds.m_volume;
+
+        if (fabs((double)mesh.m_volume - volume) > bounds.m_volume) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume error exceeds bound " << bounds.m_volume << std::endl;
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (fabs((double)mesh.m_centerOfMass[i] - (double)center[i]) > bounds.m_centerOfMass[i] + fabs(center[i]) * 1.0e-7) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass[" << i << "] error exceeds bound "
+                    << bounds.m_centerOfMass[i] << std::endl;
+            }
+            if (fabs((double)mesh.m_inertia[i][i] - (double)inertia[i][i]) > bounds.m_inertia[i][i] + inertia[i][i] * 1.0e-6) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << i << "] error exceeds bound "
+                    << bounds.m_inertia[i][i] << std::endl;
+            }
+        }
+        if (bounds.m_volume > 1.0e-3 * volume) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume bound unreasonably loose: " << bounds.m_volume << std::endl;
+        }
+
+#ifdef VERBOSE_UNIT_TESTS
+        std::cout << "offset = " << offsets[n] << "  volume = " << mesh.m_volume << " +/- " << bounds.m_volume << std::endl;
+        printMatrix("inertia", mesh.m_inertia);
+        printMatrix("inertia bounds", bounds.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+    }
+    if (volumeBounds[1] <= volumeBounds[0]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : far box should have a larger volume bound" << std::endl;
+    }
+}
+
+void MeshInfoTests::testStripsAndFans() {
+    // verify strips (with restarts and alternating winding) match the equivalent triangle list,
+    // and that fans integrate an octahedron exactly
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    // two tetrahedra, each closed by a single strip of six indices
+    VectorOfPoints points = {
+        btVector3(0.0f, 0.0f, 0.0f), btVector3(0.0f, 2.0f, 0.0f), btVector3(3.0f, 0.0f, 0.0f), btVector3(0.5f, 0.5f, 1.5f),
+        btVector3(4.0f, 1.0f, 0.0f), btVector3(4.0f, 2.0f, 0.0f), btVector3(5.0f, 1.0f, 0.0f), btVector3(4.0f, 1.0f, 1.0f) };
+    VectorOfIndices strips = { 0, 1, 2, 3, 0, 1, PRIMITIVE_RESTART_INDEX, 4, 5, 6, 7, 4, 5 };
+    VectorOfIndices triangles = {
+        0, 1, 2, 2, 1, 3, 2, 3, 0, 0, 3, 1,
+        4, 5, 6, 6, 5, 7, 6, 7, 4, 4, 7, 5 };
+
+    MeshMassProperties expectedMesh(points, triangles);
+    MeshMassProperties mesh;
+    mesh.computeMassPropertiesOfStrips(points, strips);
+
+    btScalar error = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : strip volume off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedMesh.m_centerOfMass).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : strip centerOfMass off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            error = mesh.m_inertia[i][j] - expectedMesh.m_inertia[i][j];
+            if (fabsf(error) > acceptableAbsoluteError * expectedMesh.m_inertia[i][i]) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : strip inertia[" << i << "][" << j << "] off by "
+                    << error << std::endl;
+            }
+        }
+    }
+
+    // an octahedron as two fans about its poles: volume = 4/3 and each diagonal inertia = volume / 5
+    VectorOfPoints octahedron = {
+        btVector3(0.0f, 0.0f, 1.0f), btVector3(0.0f, 0.0f, -1.0f),
+        btVector3(1.0f, 0.0f, 0.0f), btVector3(0.0f, 1.0f, 0.0f), btVector3(-1.0f, 0.0f, 0.0f), btVector3(0.0f, -1.0f, 0.0f) };
+    VectorOfIndices fans = { 0, 2, 3, 4, 5, 2, PRIMITIVE_RESTART_INDEX, 1, 2, 5, 4, 3, 2 };
+    mesh.computeMassPropertiesOfFans(octahedron, fans);
+
+    btScalar expectedVolume = 4.0f / 3.0f;
+    error = (mesh.m_volume - expectedVolume) / expectedVolume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : fan volume off by = " << error << std::endl;
+    }
+    if (mesh.m_centerOfMass.length() > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : fan centerOfMass off by = " << mesh.m_centerOfMass.length() << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        error = (mesh.m_inertia[i][i] - 0.2f * expectedVolume) / (0.2f * expectedVolume);
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : fan inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected strip volume = " << expectedMesh.m_volume << std::endl;
+    std::cout << "measured fan volume = " << mesh.m_volume << std::endl;
+    printMatrix("fan inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testPolygons() {
+    // verify a pentagonal prism given as two pentagons and five quads
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    const uint32_t NUM_SIDES = 5;
+    btScalar radius = 2.0f;
+    btScalar height = 3.0f;
+    btVector3 offset(1.0f, 2.0f, -4.0f);
+    VectorOfPoints points;
+    for (uint32_t i = 0; i < NUM_SIDES; ++i) {
+        btScalar angle = 2.0f * SIMD_PI * (btScalar)i / (btScalar)NUM_SIDES;
+        btVector3 rim(radius * cosf(angle), radius * sinf(angle), 0.0f);
+        points.push_back(offset + rim);
+        points.push_back(offset + rim + btVector3(0.0f, 0.0f, height));
+    }
+    VectorOfIndices faceSizes;
+    VectorOfIndices faceIndices;
+    // bottom face points down, top face points up
+    faceSizes.push_back(NUM_SIDES);
+    for (uint32_t i = NUM_SIDES; i > 0; --i) {
+        faceIndices.push_back(2 * (i - 1));
+    }
+    faceSizes.push_back(NUM_SIDES);
+    for (uint32_t i = 0; i < NUM_SIDES; ++i) {
+        faceIndices.push_back(2 * i + 1);
+    }
+    for (uint32_t i = 0; i < NUM_SIDES; ++i) {
+        uint32_t j = (i + 1) % NUM_SIDES;
+        faceSizes.push_back(4);
+        faceIndices.push_back(2 * i);
+        faceIndices.push_back(2 * j);
+        faceIndices.push_back(2 * j + 1);
+        faceIndices.push_back(2 * i + 1);
+    }
+
+    MeshMassProperties mesh;
+    mesh.computeMassPropertiesOfPolygons(points, faceSizes, faceIndices);
+
+    btScalar area = 0.5f * NUM_SIDES * radius * radius * sinf(2.0f * SIMD_PI / NUM_SIDES);
+    btScalar expectedVolume = area * height;
+    btVector3 expectedCenter = offset + btVector3(0.0f, 0.0f, 0.5f * height);
+    // a regular polygon has isotropic in-plane second moment: area * radius^2 * (2 + cos(2 pi / n)) / 12
+    btScalar inPlane = expectedVolume * radius * radius * (2.0f + cosf(2.0f * SIMD_PI / NUM_SIDES)) / 12.0f;
+    btScalar alongAxis = expectedVolume * height * height / 12.0f;
+
+    btScalar error = (mesh.m_volume - expectedVolume) / expectedVolume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume off by = " << error << std::endl;
+    }
+    error = (mesh.m_centerOfMass - expectedCenter).length();
+    if (fabsf(error) > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : centerOfMass off by = " << error << std::endl;
+    }
+    btScalar expectedInertia[3] = { inPlane + alongAxis, inPlane + alongAxis, 2.0f * inPlane };
+    for (int i = 0; i < 3; ++i) {
+        error = (mesh.m_inertia[i][i] - expectedInertia[i]) / expectedInertia[i];
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << i << "] off by " << error << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected volume = " << expectedVolume << std::endl;
+    std::cout << "measured volume = " << mesh.m_volume << std::endl;
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+// helper function
+void buildRevolvedMesh(const VectorOfPoints& profile, uint32_t numSectors, VectorOfPoints& points, VectorOfIndices& triangles) {
+    // Sweeps the profile (x = radius, y = height, ordered bottom to top) about the Y axis.
+    // Points on the axis are repeated per sector; the degenerate triangles they make are harmless.
+    uint32_t numRings = profile.size();
+    points.clear();
+    triangles.clear();
+    for (uint32_t j = 0; j < numSectors; ++j) {
+        btScalar angle = 2.0f * SIMD_PI * (btScalar)j / (btScalar)numSectors;
+        for (uint32_t k = 0; k < numRings; ++k) {
+            btScalar radius = profile[k][0];
+            points.push_back(btVector3(radius * cosf(angle), profile[k][1], -radius * sinf(angle)));
+        }
+    }
+    for (uint32_t j = 0; j < numSectors; ++j) {
+        uint32_t a = j * numRings;
+        uint32_t b = ((j + 1) % numSectors) * numRings;
+        for (uint32_t k = 0; k + 1 < numRings; ++k) {
+            uint32_t triangle[6] = { a + k, b + k, b + k + 1, a + k, b + k + 1, a + k + 1 };
+            triangles.insert(triangles.end(), triangle, triangle + 6);
+        }
+    }
+}
+
+// helper function
+void compareMassProperties(const char* name, const MeshMassProperties& expected, const MeshMassProperties& actual,
+        btScalar relativeError, int line) {
+    btScalar error = (actual.m_volume - expected.m_volume) / expected.m_volume;
+    if (fabsf(error) > relativeError) {
+        std::cout << __FILE__ << ":" << line << " ERROR : " << name << " volume off by = " << error << std::endl;
+    }
+    error = (actual.m_centerOfMass - expected.m_centerOfMass).length();
+    if (fabsf(error) > relativeError) {
+        std::cout << __FILE__ << ":" << line << " ERROR : " << name << " centerOfMass off by = " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        error = (actual.m_inertia[i][i] - expected.m_inertia[i][i]) / expected.m_inertia[i][i];
+        if (fabsf(error) > relativeError) {
+            std::cout << __FILE__ << ":" << line << " ERROR : " << name << " inertia[" << i << "][" << i << "] off by "
+                << error << std::endl;
+        }
+    }
+}
+
+void MeshInfoTests::testPrimitives() {
+    // verify the closed-form primitives against finely tessellated meshes of the same shapes
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    const uint32_t NUM_SECTORS = 512;
+    const btScalar TESSELLATION_ERROR = 2.0e-3f;
+    VectorOfPoints profile;
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    MeshMassProperties mesh;
+    MeshMassProperties primitive;
+
+    // cylinder
+    btScalar radius = 0.5f;
+    btScalar height = 2.0f;
+    profile = { btVector3(0.0f, -1.0f, 0.0f), btVector3(radius, -1.0f, 0.0f),
+        btVector3(radius, 1.0f, 0.0f), btVector3(0.0f, 1.0f, 0.0f) };
+    buildRevolvedMesh(profile, NUM_SECTORS, points, triangles);
+    mesh.computeMassProperties(points, triangles);
+    computeCylinderMassProperties(radius, height, primitive);
+    compareMassProperties("cylinder", mesh, primitive, TESSELLATION_ERROR, __LINE__);
+
+    // cone: apex up, centered on its height like btConeShape
+    radius = 1.0f;
+    profile = { btVector3(0.0f, -1.0f, 0.0f), btVector3(radius, -1.0f, 0.0f), btVector3(0.0f, 1.0f, 0.0f) };
+    buildRevolvedMesh(profile, NUM_SECTORS, points, triangles);
+    mesh.computeMassProperties(points, triangles);
+    computeConeMassProperties(radius, height, primitive);
+    compareMassProperties("cone", mesh, primitive, TESSELLATION_ERROR, __LINE__);
+
+    // capsule
+    const uint32_t NUM_ARC_STEPS = 64;
+    radius = 0.5f;
+    height = 1.0f;
+    profile.clear();
+    for (uint32_t k = 0; k <= NUM_ARC_STEPS; ++k) {
+        btScalar angle = 0.5f * SIMD_PI * (btScalar)k / (btScalar)NUM_ARC_STEPS;
+        profile.push_back(btVector3(radius * sinf(angle), -0.5f * height - radius * cosf(angle), 0.0f));
+    }
+    for (uint32_t k = 0; k <= NUM_ARC_STEPS; ++k) {
+        btScalar angle = 0.5f * SIMD_PI * (btScalar)k / (btScalar)NUM_ARC_STEPS;
+        profile.push_back(btVector3(radius * cosf(angle), 0.5f * height + radius * sinf(angle), 0.0f));
+    }
+    buildRevolvedMesh(profile, NUM_SECTORS, points, triangles);
+    mesh.computeMassProperties(points, triangles);
+    computeCapsuleMassProperties(radius, height, primitive);
+    compareMassProperties("capsule", mesh, primitive, TESSELLATION_ERROR, __LINE__);
+
+    // the batched capsule must agree with the single one
+    btScalar radii[3] = { 0.25f, radius, 2.0f };
+    btScalar heights[3] = { 3.0f, height, 0.0f };
+    btScalar volumes[3], inertiaX[3], inertiaY[3], inertiaZ[3];
+    computeCapsuleMassPropertiesBatch(3, radii, heights, volumes, inertiaX, inertiaY, inertiaZ);
+    if (volumes[1] != primitive.m_volume || inertiaX[1] != primitive.m_inertia[0][0]
+            || inertiaY[1] != primitive.m_inertia[1][1] || inertiaZ[1] != primitive.m_inertia[2][2]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : batched capsule disagrees with single capsule" << std::endl;
+    }
+    // a capsule of zero height is a sphere
+    computeSphereMassProperties(radii[2], primitive);
+    if (fabsf(volumes[2] - primitive.m_volume) > acceptableRelativeError * primitive.m_volume
+            || fabsf(inertiaX[2] - primitive.m_inertia[0][0]) > acceptableRelativeError * primitive.m_inertia[0][0]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : zero height capsule is not a sphere" << std::endl;
+    }
+
+    // convex polyhedron: a box far from the origin given as six quads
+    btVector3 halfExtents(1.5f, 0.5f, 2.0f);
+    btVector3 center(300.0f, -120.0f, 45.0f);
+    VectorOfIndices boxTriangles;
+    buildBoxMesh(2.0f * halfExtents[0], 2.0f * halfExtents[1], 2.0f * halfExtents[2], points, boxTriangles);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += center - halfExtents;
+    }
+    VectorOfIndices faceSizes(boxTriangles.size() / 3, 3);
+    computeConvexPolyhedronMassProperties(points, faceSizes, boxTriangles, mesh);
+    computeBoxMassProperties(halfExtents, primitive);
+    primitive.m_centerOfMass = center;
+    compareMassProperties("polyhedron", primitive, mesh, acceptableRelativeError, __LINE__);
+
+    // compound of two spheres either side of the origin
+    radius = 0.5f;
+    btScalar distance = 2.0f;
+    MassPropertiesAccumulator totals;
+    btMatrix3x3 identity;
+    identity.setIdentity();
+    for (int side = -1; side <= 1; side += 2) {
+        computeSphereMassProperties(radius, primitive);
+        transformMassProperties(primitive, identity, btVector3(side * distance, 0.0f, 0.0f));
+        totals.addMassProperties(primitive);
+    }
+    totals.getMassProperties(mesh);
+    computeSphereMassProperties(radius, primitive);
+    btScalar expectedInertia = 2.0f * (primitive.m_inertia[1][1] + primitive.m_volume * distance * distance);
+    btScalar error = (mesh.m_inertia[1][1] - expectedInertia) / expectedInertia;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : compound inertia off by " << error << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    printMatrix("compound inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testConvexHull() {
+    // verify the hull of a box's corners plus interior clutter is the box, and that the hull of
+    // points on a sphere is closed and slightly smaller than the sphere
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    // deterministic pseudo-random numbers in [0, 1)
+    uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (btScalar)(seed >> 8) / (btScalar)(1 << 24);
+    };
+
+    btVector3 corner(-7.0f, 20.0f, 3.0f);
+    btVector3 diagonal(2.0f, 3.0f, 4.0f);
+    VectorOfPoints points;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        points.push_back(corner + btVector3(random() * diagonal[0], random() * diagonal[1], random() * diagonal[2]));
+    }
+    for (uint32_t i = 0; i < 8; ++i) {
+        btVector3 offset((i & 1) ? diagonal[0] : 0.0f, (i & 2) ? diagonal[1] : 0.0f, (i & 4) ? diagonal[2] : 0.0f);
+        points.push_back(corner + offset);
+    }
+
+    MeshMassProperties hull;
+    VectorOfIndices hullTriangles;
+    if (!computeConvexHullMassProperties(points, hull, hullTriangles, 4)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : box hull failed" << std::endl;
+    }
+    MeshMassProperties expectedBox;
+    expectedBox.m_volume = diagonal[0] * diagonal[1] * diagonal[2];
+    expectedBox.m_centerOfMass = corner + 0.5f * diagonal;
+    computeBoxInertia(expectedBox.m_volume, diagonal, expectedBox.m_inertia);
+    compareMassProperties("box hull", expectedBox, hull, acceptableRelativeError, __LINE__);
+    if (hullTriangles.size() != 3 * 12) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : box hull has " << hullTriangles.size() / 3
+            << " triangles instead of 12" << std::endl;
+    }
+
+    // points on a sphere: every point is on the hull
+    btScalar radius = 3.0f;
+    points.clear();
+    for (uint32_t i = 0; i < 2000; ++i) {
+        btVector3 direction;
+        do {
+            direction = btVector3(2.0f * random() - 1.0f, 2.0f * random() - 1.0f, 2.0f * random() - 1.0f);
+        } while (direction.length2() > 1.0f || direction.length2() < 0.01f);
+        points.push_back(radius * direction.normalized());
+    }
+    if (!computeConvexHullMassProperties(points, hull, hullTriangles)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : sphere hull failed" << std::endl;
+    }
+    MeshTopologyReport report;
+    MeshMassProperties mesh;
+    mesh.computeMassProperties(points, hullTriangles, report);
+    if (!report.isClosedAndConsistent()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : sphere hull is not closed and consistent" << std::endl;
+    }
+    btScalar sphereVolume = (4.0f / 3.0f) * SIMD_PI * radius * radius * radius;
+    btScalar error = (sphereVolume - hull.m_volume) / sphereVolume;
+    if (error < 0.0f || error > 0.02f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : sphere hull volume off by " << error << std::endl;
+    }
+    error = (hull.m_volume - mesh.m_volume) / mesh.m_volume;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : hull volume disagrees with its mesh by " << error << std::endl;
+    }
+    if (2 * points.size() - 4 != hullTriangles.size() / 3) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : sphere hull has " << hullTriangles.size() / 3
+            << " triangles, expected " << 2 * points.size() - 4 << std::endl;
+    }
+
+    // all points on one plane
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i][2] = 1.0f;
+    }
+    if (computeConvexHullMassProperties(points, hull, hullTriangles)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : flat point cloud produced a hull" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "sphere volume = " << sphereVolume << std::endl;
+    std::cout << "hull volume = " << mesh.m_volume << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testSkinnedMesh() {
+    // verify a rigidly posed skinned box matches the transformed box, and that moving the bone
+    // that owns the top of the box stretches it
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    btScalar x(2.0f), y(3.0f), z(1.0f);
+    SkinnedMesh mesh;
+    buildBoxMesh(x, y, z, mesh.m_restPoints, mesh.m_triangleIndices);
+    uint32_t numPoints = mesh.m_restPoints.size();
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        // bottom points follow bone 0, top points are split between bones 1 and 2
+        bool top = mesh.m_restPoints[i][2] > 0.5f * z;
+        uint16_t bones[BONES_PER_POINT] = { 0, 1, 2, 0 };
+        btScalar weights[BONES_PER_POINT] = { top ? 0.0f : 1.0f, top ? 0.5f : 0.0f, top ? 0.5f : 0.0f, 0.0f };
+        mesh.m_boneIndices.insert(mesh.m_boneIndices.end(), bones, bones + BONES_PER_POINT);
+        mesh.m_boneWeights.insert(mesh.m_boneWeights.end(), weights, weights + BONES_PER_POINT);
+    }
+
+    // every bone shares one rigid transform
+    btMatrix3x3 rotation(0.36f, 0.48f, -0.8f, -0.8f, 0.6f, 0.0f, 0.48f, 0.64f, 0.6f);
+    btVector3 translation(4.0f, -1.0f, 2.5f);
+    std::vector<btTransform> palette(3, btTransform(rotation, translation));
+    MeshMassProperties skinned;
+    computeSkinnedMassProperties(mesh, palette, skinned);
+    MeshMassProperties expected(mesh.m_restPoints, mesh.m_triangleIndices);
+    transformMassProperties(expected, rotation, translation);
+    compareMassProperties("rigid pose", expected, skinned, acceptableRelativeError, __LINE__);
+
+    // bones 1 and 2 lift the top by different amounts, so the top moves by their average
+    btScalar lift = 1.5f;
+    palette[0].setIdentity();
+    palette[1].setIdentity();
+    palette[1].setOrigin(btVector3(0.0f, 0.0f, 0.5f * lift));
+    palette[2].setIdentity();
+    palette[2].setOrigin(btVector3(0.0f, 0.0f, 1.5f * lift));
+    computeSkinnedMassProperties(mesh, palette, skinned, 2);
+    expected.m_volume = x * y * (z + lift);
+    expected.m_centerOfMass = 0.5f * btVector3(x, y, z + lift);
+    computeBoxInertia(expected.m_volume, btVector3(x, y, z + lift), expected.m_inertia);
+    compareMassProperties("stretched pose", expected, skinned, acceptableRelativeError, __LINE__);
+
+#ifdef VERBOSE_UNIT_TESTS
+    printMatrix("stretched inertia", skinned.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testMorphTargets() {
+    // verify the blend-weight polynomials reproduce a direct integration of the blended mesh
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints basePoints;
+    VectorOfIndices triangles;
+    buildBoxMesh(2.0f, 1.0f, 3.0f, basePoints, triangles);
+    uint32_t numPoints = basePoints.size();
+
+    // target 0 lifts the top, target 1 slides everything along x, target 2 pinches one corner
+    std::vector<MorphTarget> targets(3);
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        if (basePoints[i][2] > 1.5f) {
+            targets[0].m_points.push_back(i);
+            targets[0].m_offsets.push_back(btVector3(0.0f, 0.0f, 1.0f));
+        }
+        targets[1].m_points.push_back(i);
+        targets[1].m_offsets.push_back(btVector3(2.0f, 0.0f, 0.0f));
+    }
+    targets[2].m_points.push_back(numPoints - 1);
+    targets[2].m_offsets.push_back(btVector3(-0.5f, 0.25f, 0.5f));
+
+    MorphMassProperties morph(basePoints, triangles, targets);
+
+    btScalar weightSets[3][3] = { { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.3f, 1.0f }, { 1.7f, -1.0f, 0.6f } };
+    for (uint32_t n = 0; n < 3; ++n) {
+        std::vector<btScalar> weights(weightSets[n], weightSets[n] + 3);
+        VectorOfPoints blended = basePoints;
+        for (uint32_t k = 0; k < targets.size(); ++k) {
+            for (uint32_t i = 0; i < targets[k].m_points.size(); ++i) {
+                blended[targets[k].m_points[i]] += weights[k] * targets[k].m_offsets[i];
+            }
+        }
+        MeshMassProperties expected(blended, triangles);
+        MeshMassProperties evaluated;
+        morph.evaluate(weights, evaluated);
+        compareMassProperties("morph", expected, evaluated, acceptableRelativeError, __LINE__);
+    }
+
+    // twelve targets that all move every corner: each triangle sees all of them, which is the
+    // dense worst case, and repeated weights exercise every multiplicity of the monomials
+    const uint32_t NUM_DENSE_TARGETS = 12;
+    std::vector<MorphTarget> denseTargets(NUM_DENSE_TARGETS);
+    for (uint32_t k = 0; k < NUM_DENSE_TARGETS; ++k) {
+        for (uint32_t i = 0; i < numPoints; ++i) {
+            btScalar phase = (btScalar)(7 * k + 3 * i);
+            denseTargets[k].m_points.push_back(i);
+            denseTargets[k].m_offsets.push_back(0.1f * btVector3(sinf(phase), cosf(1.3f * phase), sinf(0.7f * phase + 1.0f)));
+        }
+    }
+    MorphMassProperties denseMorph(basePoints, triangles, denseTargets);
+    uint32_t n = NUM_DENSE_TARGETS + 1;
+    uint32_t maxTerms = n * (n + 1) * (n + 2) / 6 + n * (n + 1) * (n + 2) * (n + 3) / 24
+        + n * (n + 1) * (n + 2) * (n + 3) * (n + 4) / 120;
+    if (denseMorph.getNumTerms() > maxTerms) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << denseMorph.getNumTerms()
+            << " terms exceed the " << maxTerms << " distinct monomials" << std::endl;
+    }
+    for (uint32_t trial = 0; trial < 3; ++trial) {
+        std::vector<btScalar> weights(NUM_DENSE_TARGETS);
+        VectorOfPoints blended = basePoints;
+        for (uint32_t k = 0; k < NUM_DENSE_TARGETS; ++k) {
+            weights[k] = (trial == 0) ? 1.0f : cosf((btScalar)(5 * k + trial));
+            for (uint32_t i = 0; i < numPoints; ++i) {
+                blended[i] += weights[k] * denseTargets[k].m_offsets[i];
+            }
+        }
+        MeshMassProperties expected(blended, triangles);
+        MeshMassProperties evaluated;
+        denseMorph.evaluate(weights, evaluated);
+        compareMassProperties("dense morph", expected, evaluated, acceptableRelativeError, __LINE__);
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "number of terms = " << morph.getNumTerms() << std::endl;
+    std::cout << "dense terms = " << denseMorph.getNumTerms() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testMeshSequence() {
+    // verify each frame of a sequence matches integrating that frame alone, whether the frames
+    // come from memory or from a loader, and that frames that fail to load are flagged
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints basePoints;
+    VectorOfIndices triangles;
+    buildBoxMesh(1.0f, 2.0f, 3.0f, basePoints, triangles);
+    uint32_t numPoints = basePoints.size();
+    const uint32_t NUM_FRAMES = 20;
+    auto buildFrame = [&](uint32_t frame, VectorOfPoints& points) {
+        btScalar stretch = 1.0f + 0.1f * frame;
+        points.resize(numPoints);
+        for (uint32_t i = 0; i < numPoints; ++i) {
+            const btVector3& p = basePoints[i];
+            points[i] = btVector3(stretch * p[0] + 0.2f * p[2], p[1] - 0.5f * frame, p[2]);
+        }
+    };
+    VectorOfPoints frames;
+    VectorOfPoints points;
+    for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame) {
+        buildFrame(frame, points);
+        frames.insert(frames.end(), points.begin(), points.end());
+    }
+
+    MeshSequenceMassProperties sequence(numPoints, triangles);
+    MassPropertiesSeries fromMemory;
+    sequence.computeFrames(frames, fromMemory, 3);
+    MassPropertiesSeries fromLoader;
+    sequence.computeFrames(NUM_FRAMES, [&](uint32_t frame, VectorOfPoints& points) {
+        if (frame == 7) {
+            return false;
+        }
+        buildFrame(frame, points);
+        return true;
+    }, fromLoader, 3);
+
+    // the sequence integrates the triangles in a different order, so rounding differs slightly
+    const btScalar SEQUENCE_ERROR = 1.0e-4f;
+    MeshMassProperties result;
+    for (uint32_t frame = 0; frame < NUM_FRAMES; ++frame) {
+        buildFrame(frame, points);
+        MeshMassProperties expected(points, triangles);
+        fromMemory.getFrame(frame, result);
+        compareMassProperties("sequence frame", expected, result, SEQUENCE_ERROR, __LINE__);
+        if (frame == 7) {
+            if (fromLoader.m_valid[frame]) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : missing frame marked valid" << std::endl;
+            }
+            continue;
+        }
+        fromLoader.getFrame(frame, result);
+        compareMassProperties("loaded frame", expected, result, SEQUENCE_ERROR, __LINE__);
+    }
+}
+
+void MeshInfoTests::testVoxelGrid() {
+    // verify an L-shaped block of voxels that straddles 64-bit word boundaries against the sum
+    // of the two boxes it is made of
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VoxelGrid grid;
+    grid.resize(150, 40, 30);
+    grid.m_voxelSize = 0.05f;
+    grid.m_origin = btVector3(-2.0f, 1.0f, 0.5f);
+    // box A: x in [3, 140), y in [5, 20), z in [2, 12)
+    // box B: x in [60, 70), y in [20, 38), z in [2, 29)
+    uint32_t boxes[2][6] = { { 3, 140, 5, 20, 2, 12 }, { 60, 70, 20, 38, 2, 29 } };
+    MassPropertiesAccumulator totals;
+    btMatrix3x3 identity;
+    identity.setIdentity();
+    for (uint32_t b = 0; b < 2; ++b) {
+        const uint32_t* box = boxes[b];
+        for (uint32_t z = box[4]; z < box[5]; ++z) {
+            for (uint32_t y = box[2]; y < box[3]; ++y) {
+                for (uint32_t x = box[0]; x < box[1]; ++x) {
+                    grid.set(x, y, z);
+                }
+            }
+        }
+        btVector3 minCorner((btScalar)box[0], (btScalar)box[2], (btScalar)box[4]);
+        btVector3 maxCorner((btScalar)box[1], (btScalar)box[3], (btScalar)box[5]);
+        MeshMassProperties part;
+        computeBoxMassProperties(0.5f * grid.m_voxelSize * (maxCorner - minCorner), part);
+        transformMassProperties(part, identity, grid.m_origin + 0.5f * grid.m_voxelSize * (minCorner + maxCorner));
+        totals.addMassProperties(part);
+    }
+    // stray bits past the end of each row must be ignored
+    grid.getRow(0, 0)[grid.getWordsPerRow() - 1] |= ~(uint64_t)0 << (grid.m_numX % 64);
+
+    MeshMassProperties expected;
+    totals.getMassProperties(expected);
+    MeshMassProperties voxels;
+    computeVoxelMassProperties(grid, voxels, 2);
+    compareMassProperties("voxels", expected, voxels, acceptableRelativeError, __LINE__);
+    btScalar error = voxels.m_inertia[0][1] - expected.m_inertia[0][1];
+    if (fabsf(error) > acceptableRelativeError * expected.m_inertia[0][0]) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : voxels inertia[0][1] off by " << error << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    printMatrix("expected inertia", expected.m_inertia);
+    printMatrix("voxel inertia", voxels.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+// helper function
+void buildSparseSdfGrid(const std::function<btScalar(const btVector3&)>& distanceFunction, uint32_t numBricksPerSide,
+        SparseSdfGrid& grid) {
+    // samples the function at voxel centers, keeping bricks near the surface and listing the
+    // bricks that are entirely inside as interior tiles
+    grid.m_bricks.clear();
+    grid.m_interiorTiles.clear();
+    btScalar h = grid.m_voxelSize;
+    for (uint32_t bz = 0; bz < numBricksPerSide; ++bz) {
+        for (uint32_t by = 0; by < numBricksPerSide; ++by) {
+            for (uint32_t bx = 0; bx < numBricksPerSide; ++bx) {
+                SdfBrick brick;
+                brick.m_x = bx;
+                brick.m_y = by;
+                brick.m_z = bz;
+                btScalar minDistance = FLT_MAX;
+                btScalar maxDistance = -FLT_MAX;
+                uint32_t v = 0;
+                for (uint32_t z = 0; z < SDF_BRICK_SIZE; ++z) {
+                    for (uint32_t y = 0; y < SDF_BRICK_SIZE; ++y) {
+                        for (uint32_t x = 0; x < SDF_BRICK_SIZE; ++x, ++v) {
+                            btVector3 center = grid.m_origin + h * btVector3(bx * SDF_BRICK_SIZE + x + 0.5f,
+                                    by * SDF_BRICK_SIZE + y + 0.5f, bz * SDF_BRICK_SIZE + z + 0.5f);
+                            btScalar distance = distanceFunction(center);
+                            brick.m_distances[v] = distance;
+                            minDistance = btMin(minDistance, distance);
+                            maxDistance = btMax(maxDistance, distance);
+                        }
+                    }
+                }
+                if (maxDistance < -h) {
+                    grid.m_interiorTiles.push_back(bx);
+                    grid.m_interiorTiles.push_back(by);
+                    grid.m_interiorTiles.push_back(bz);
+                } else if (minDistance < h) {
+                    grid.m_bricks.push_back(brick);
+                }
+            }
+        }
+    }
+}
+
+void MeshInfoTests::testSparseSdf() {
+    // verify a voxel-aligned box exactly and a sphere approximately
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    SparseSdfGrid grid;
+    grid.m_voxelSize = 0.1f;
+    grid.m_origin = btVector3(10.0f, -5.0f, 2.0f);
+
+    // box with faces on voxel boundaries: 3 to 29 voxels in x, 5 to 22 in y, 8 to 40 in z
+    btVector3 boxMin = grid.m_origin + grid.m_voxelSize * btVector3(3.0f, 5.0f, 8.0f);
+    btVector3 boxMax = grid.m_origin + grid.m_voxelSize * btVector3(29.0f, 22.0f, 40.0f);
+    buildSparseSdfGrid([&](const btVector3& p) {
+        btScalar distance = -FLT_MAX;
+        for (int i = 0; i < 3; ++i) {
+            distance = btMax(distance, btMax(boxMin[i] - p[i], p[i] - boxMax[i]));
+        }
+        return distance;
+    }, 6, grid);
+    MeshMassProperties expected;
+    computeBoxMassProperties(0.5f * (boxMax - boxMin), expected);
+    expected.m_centerOfMass = 0.5f * (boxMin + boxMax);
+    MeshMassProperties sdf;
+    computeSdfMassProperties(grid, sdf, 2);
+    compareMassProperties("sdf box", expected, sdf, 1.0e-4f, __LINE__);
+    if (grid.m_interiorTiles.empty()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : sdf box has no interior tiles" << std::endl;
+    }
+
+    // sphere
+    btScalar radius = 1.9f;
+    btVector3 center = grid.m_origin + btVector3(2.4f, 2.4f, 2.4f);
+    buildSparseSdfGrid([&](const btVector3& p) { return (p - center).length() - radius; }, 6, grid);
+    computeSphereMassProperties(radius, expected);
+    expected.m_centerOfMass = center;
+    computeSdfMassProperties(grid, sdf);
+    compareMassProperties("sdf sphere", expected, sdf, 5.0e-3f, __LINE__);
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "sphere volume = " << expected.m_volume << "  sdf volume = " << sdf.m_volume << std::endl;
+    std::cout << "bricks = " << grid.m_bricks.size() << "  tiles = " << grid.m_interiorTiles.size() / 3 << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testPointMasses() {
+    // verify point masses at the corners of a box far from the origin, alone and as one of
+    // several interleaved bodies
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    // a mass m at each of the 8 corners of a box with half extents a, b, c has inertia
+    // 8 m (b^2 + c^2) about x, and so on
+    btVector3 halfExtents(1.0f, 2.0f, 0.5f);
+    btScalar cornerMass = 0.25f;
+    const uint32_t NUM_BODIES = 3;
+    const uint32_t NUM_COPIES = 5000;
+    std::vector<btScalar> x, y, z, mass;
+    std::vector<uint32_t> segment;
+    for (uint32_t copy = 0; copy < NUM_COPIES; ++copy) {
+        for (uint32_t body = 0; body < NUM_BODIES; ++body) {
+            btVector3 center(1000.0f * body + 5000.0f, -2000.0f, 300.0f * body);
+            for (uint32_t corner = 0; corner < 8; ++corner) {
+                btVector3 offset((corner & 1) ? halfExtents[0] : -halfExtents[0], (corner & 2) ? halfExtents[1] : -halfExtents[1],
+                        (corner & 4) ? halfExtents[2] : -halfExtents[2]);
+                btVector3 point = center + (btScalar)(body + 1) * offset;
+                x.push_back(point[0]);
+                y.push_back(point[1]);
+                z.push_back(point[2]);
+                mass.push_back(cornerMass);
+                segment.push_back(body);
+            }
+        }
+    }
+
+    btScalar totalMass[NUM_BODIES];
+    btScalar centers[3 * NUM_BODIES];
+    btScalar inertias[6 * NUM_BODIES];
+    computeSegmentedPointMassProperties(x.size(), x.data(), y.data(), z.data(), mass.data(), segment.data(), NUM_BODIES,
+            totalMass, centers, inertias, 2);
+    for (uint32_t body = 0; body < NUM_BODIES; ++body) {
+        btScalar expectedMass = 8.0f * NUM_COPIES * cornerMass;
+        btVector3 e = (btScalar)(body + 1) * halfExtents;
+        btScalar expectedInertia[3] = {
+            expectedMass * (e[1] * e[1] + e[2] * e[2]),
+            expectedMass * (e[2] * e[2] + e[0] * e[0]),
+            expectedMass * (e[0] * e[0] + e[1] * e[1]) };
+        btVector3 expectedCenter(1000.0f * body + 5000.0f, -2000.0f, 300.0f * body);
+        if (fabsf(totalMass[body] - expectedMass) > acceptableRelativeError * expectedMass) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body " << body << " mass = " << totalMass[body] << std::endl;
+        }
+        for (uint32_t k = 0; k < 3; ++k) {
+            if (fabsf(centers[3 * body + k] - expectedCenter[k]) > acceptableAbsoluteError) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body " << body << " center[" << k << "] = "
+                    << centers[3 * body + k] << std::endl;
+            }
+            btScalar error = (inertias[6 * body + k] - expectedInertia[k]) / expectedInertia[k];
+            if (fabsf(error) > acceptableRelativeError) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body " << body << " inertia[" << k << "] off by "
+                    << error << std::endl;
+            }
+            if (fabsf(inertias[6 * body + 3 + k]) > acceptableRelativeError * expectedInertia[k]) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body " << body << " product of inertia = "
+                    << inertias[6 * body + 3 + k] << std::endl;
+            }
+        }
+    }
+
+    // the unsegmented call over every point sees the three bodies as one
+    btScalar allMass;
+    btVector3 allCenter;
+    btMatrix3x3 allInertia;
+    computePointMassProperties(x.size(), x.data(), y.data(), z.data(), mass.data(), allMass, allCenter, allInertia);
+    MassPropertiesAccumulator totals;
+    for (uint32_t body = 0; body < NUM_BODIES; ++body) {
+        MeshMassProperties part;
+        part.m_volume = totalMass[body];
+        part.m_mass = totalMass[body];
+        part.m_centerOfMass.setValue(centers[3 * body], centers[3 * body + 1], centers[3 * body + 2]);
+        const btScalar* i = &inertias[6 * body];
+        part.m_inertia.setValue(i[0], i[3], i[4], i[3], i[1], i[5], i[4], i[5], i[2]);
+        totals.addMassProperties(part);
+    }
+    MeshMassProperties expected;
+    totals.getMassProperties(expected);
+    MeshMassProperties all;
+    all.m_volume = allMass;
+    all.m_mass = allMass;
+    all.m_centerOfMass = allCenter;
+    all.m_inertia = allInertia;
+    compareMassProperties("all points", expected, all, 1.0e-4f, __LINE__);
+
+    // many small bodies, some contiguous and some scattered, plus one with no points: a pool
+    // must give the same bits as one thread
+    const uint32_t NUM_SMALL_BODIES = 50000;
+    std::vector<btScalar> sx, sy, sz, smass;
+    std::vector<uint32_t> smallSegment;
+    for (uint32_t i = 0; i < 4 * NUM_SMALL_BODIES; ++i) {
+        uint32_t body = (i < 2 * (NUM_SMALL_BODIES - 1)) ? i / 2 : (i * 7919) % (NUM_SMALL_BODIES - 1);
+        sx.push_back((btScalar)body + 0.25f * (btScalar)(i % 3));
+        sy.push_back(0.5f * (btScalar)(i % 5));
+        sz.push_back(-(btScalar)(i % 7));
+        smass.push_back(1.0f + (btScalar)(i % 4));
+        smallSegment.push_back(body);
+    }
+    std::vector<btScalar> serialResults(10 * NUM_SMALL_BODIES);
+    std::vector<btScalar> pooledResults(10 * NUM_SMALL_BODIES);
+    btScalar* serial = serialResults.data();
+    btScalar* pooled = pooledResults.data();
+    computeSegmentedPointMassProperties(sx.size(), sx.data(), sy.data(), sz.data(), smass.data(), smallSegment.data(),
+            NUM_SMALL_BODIES, serial, serial + NUM_SMALL_BODIES, serial + 4 * NUM_SMALL_BODIES, 1);
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    computeSegmentedPointMassProperties(sx.size(), sx.data(), sy.data(), sz.data(), smass.data(), smallSegment.data(),
+            NUM_SMALL_BODIES, pooled, pooled + NUM_SMALL_BODIES, pooled + 4 * NUM_SMALL_BODIES);
+    setDefaultTaskExecutor(nullptr);
+    if (serialResults != pooledResults) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : segmented results depend on the number of threads" << std::endl;
+    }
+    uint32_t empty = NUM_SMALL_BODIES - 1;
+    if (serial[empty] != 0.0f || serial[4 * NUM_SMALL_BODIES + 6 * empty] != 0.0f) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body without points has mass " << serial[empty] << std::endl;
+    }
+    btScalar expectedBodyMass = 0.0f;
+    for (uint32_t i = 0; i < sx.size(); ++i) {
+        if (smallSegment[i] == 1) {
+            expectedBodyMass += smass[i];
+        }
+    }
+    if (serial[1] != expectedBodyMass) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : body 1 mass = " << serial[1] << ", expected "
+            << expectedBodyMass << std::endl;
+    }
+}
+
+void MeshInfoTests::testTetrahedra() {
+    // verify two boxes of different density, each cut into five tetrahedra, against the sum of
+    // the two boxes
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    // corner (i, j, k) of a box is point i + 2j + 4k: one central tetrahedron plus four at corners
+    const uint32_t BOX_TETRAHEDRA[5][4] = { { 1, 2, 4, 7 }, { 0, 1, 2, 4 }, { 3, 1, 2, 7 }, { 5, 1, 4, 7 }, { 6, 2, 4, 7 } };
+    btVector3 lowerMin(-1.0f, 2.0f, 3.0f);
+    btVector3 size(2.0f, 1.0f, 1.5f);
+    btVector3 upperMin = lowerMin + btVector3(0.0f, 0.0f, size[2]);
+    btScalar densities[2] = { 3.0f, 1.0f };
+
+    VectorOfPoints points;
+    VectorOfIndices tetrahedra;
+    std::vector<btScalar> tetrahedronDensities;
+    MassPropertiesAccumulator totals;
+    btMatrix3x3 identity;
+    identity.setIdentity();
+    for (uint32_t b = 0; b < 2; ++b) {
+        btVector3 boxMin = (b == 0) ? lowerMin : upperMin;
+        uint32_t first = points.size();
+        for (uint32_t corner = 0; corner < 8; ++corner) {
+            points.push_back(boxMin + btVector3((corner & 1) ? size[0] : 0.0f, (corner & 2) ? size[1] : 0.0f,
+                    (corner & 4) ? size[2] : 0.0f));
+        }
+        for (uint32_t t = 0; t < 5; ++t) {
+            for (uint32_t k = 0; k < 4; ++k) {
+                tetrahedra.push_back(first + BOX_TETRAHEDRA[t][k]);
+            }
+            tetrahedronDensities.push_back(densities[b]);
+        }
+
+        MeshMassProperties box;
+        computeBoxMassProperties(0.5f * size, box);
+        box.m_mass *= densities[b];
+        box.m_inertia = box.m_inertia.scaled(btVector3(densities[b], densities[b], densities[b]));
+        transformMassProperties(box, identity, boxMin + 0.5f * size);
+        totals.addMassProperties(box);
+    }
+    MeshMassProperties expected;
+    totals.getMassProperties(expected);
+
+    MeshMassProperties mesh;
+    mesh.computeMassPropertiesOfTetrahedra(points, tetrahedra, tetrahedronDensities, 2);
+    compareMassProperties("tetrahedra", expected, mesh, acceptableRelativeError, __LINE__);
+    btScalar error = (mesh.m_mass - expected.m_mass) / expected.m_mass;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : mass off by " << error << std::endl;
+    }
+
+    // without densities the mass is the volume and the center is the middle of the stack
+    mesh.computeMassPropertiesOfTetrahedra(points, tetrahedra);
+    btVector3 expectedCenter = lowerMin + btVector3(0.5f * size[0], 0.5f * size[1], size[2]);
+    if (mesh.m_mass != mesh.m_volume || (mesh.m_centerOfMass - expectedCenter).length() > acceptableAbsoluteError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : unit density tetrahedra off" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected mass = " << expected.m_mass << "  measured mass = " << mesh.m_mass << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testDensityPolynomial() {
+    // verify a box with a quadratic density against integrals done axis by axis
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    btVector3 boxMin(1.0f, -2.0f, 0.5f);
+    btVector3 size(2.0f, 3.0f, 1.5f);
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(size[0], size[1], size[2], points, triangles);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += boxMin;
+    }
+    DensityPolynomial density;
+    density.m_constant = 2.0f;
+    density.m_linear = btVector3(0.5f, -0.25f, 0.3f);
+    density.m_quadratic.setValue(0.1f, 0.05f, 0.0f, 0.05f, 0.2f, -0.1f, 0.0f, -0.1f, 0.15f);
+
+    // integral over the box of x^p y^q z^r
+    auto boxIntegral = [&](const int* powers) {
+        double product = 1.0;
+        for (int k = 0; k < 3; ++k) {
+            double low = boxMin[k];
+            double high = boxMin[k] + size[k];
+            int n = powers[k] + 1;
+            product *= (pow(high, n) - pow(low, n)) / n;
+        }
+        return product;
+    };
+    // integral of density * x_a * x_b (pass -1 to leave a factor out)
+    auto weightedIntegral = [&](int a, int b) {
+        int powers[3] = { 0, 0, 0 };
+        if (a >= 0) {
+            ++powers[a];
+        }
+        if (b >= 0) {
+            ++powers[b];
+        }
+        double sum = density.m_constant * boxIntegral(powers);
+        for (int i = 0; i < 3; ++i) {
+            ++powers[i];
+            sum += density.m_linear[i] * boxIntegral(powers);
+            for (int j = 0; j < 3; ++j) {
+                ++powers[j];
+                sum += density.m_quadratic[i][j] * boxIntegral(powers);
+                --powers[j];
+            }
+            --powers[i];
+        }
+        return sum;
+    };
+    double mass = weightedIntegral(-1, -1);
+    double center[3];
+    for (int i = 0; i < 3; ++i) {
+        center[i] = weightedIntegral(i, -1) / mass;
+    }
+    double secondMoment[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            secondMoment[i][j] = weightedIntegral(i, j) - mass * center[i] * center[j];
+        }
+    }
+    MeshMassProperties expected;
+    expected.m_volume = size[0] * size[1] * size[2];
+    expected.m_mass = mass;
+    expected.m_centerOfMass.setValue(center[0], center[1], center[2]);
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            expected.m_inertia[i][j] = (i == j ? trace : 0.0) - secondMoment[i][j];
+        }
+    }
+
+    MeshMassProperties mesh;
+    mesh.computeMassProperties(points, triangles, density);
+    compareMassProperties("density", expected, mesh, acceptableRelativeError, __LINE__);
+    btScalar error = (mesh.m_mass - expected.m_mass) / expected.m_mass;
+    if (fabsf(error) > acceptableRelativeError) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : mass off by " << error << std::endl;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = i + 1; j < 3; ++j) {
+            error = mesh.m_inertia[i][j] - expected.m_inertia[i][j];
+            if (fabsf(error) > acceptableRelativeError * expected.m_inertia[i][i]) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : inertia[" << i << "][" << j << "] off by " << error << std::endl;
+            }
+        }
+    }
+
+    // a zero density leaves no mass to balance: the result must stay finite
+    DensityPolynomial vacuum;
+    vacuum.m_constant = 0.0f;
+    MeshMassProperties empty;
+    empty.computeMassProperties(points, triangles, vacuum);
+    btVector3 centroid(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        centroid += points[i];
+    }
+    centroid /= (btScalar)points.size();
+    if (empty.m_mass != 0.0f || (empty.m_centerOfMass - centroid).length() > acceptableAbsoluteError
+            || !std::isfinite(empty.m_inertia[0].length2() + empty.m_inertia[1].length2() + empty.m_inertia[2].length2())) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : zero density gave mass " << empty.m_mass
+            << " and center " << empty.m_centerOfMass[0] << std::endl;
+    }
+
+    // enough copies of the box to span several chunks must give the same bits on a pool as on
+    // one thread
+    const uint32_t NUM_COPIES = 2000;
+    VectorOfPoints manyPoints;
+    VectorOfIndices manyTriangles;
+    for (uint32_t copy = 0; copy < NUM_COPIES; ++copy) {
+        uint32_t first = manyPoints.size();
+        btVector3 offset(3.0f * (copy % 40), 4.0f * (copy / 40), 0.0f);
+        for (const btVector3& point : points) {
+            manyPoints.push_back(point + offset);
+        }
+        for (uint32_t index : triangles) {
+            manyTriangles.push_back(first + index);
+        }
+    }
+    MeshMassProperties serial;
+    serial.computeMassProperties(manyPoints, manyTriangles, density, 1);
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    MeshMassProperties pooled;
+    pooled.computeMassProperties(manyPoints, manyTriangles, density);
+    setDefaultTaskExecutor(nullptr);
+    bool identical = serial.m_mass == pooled.m_mass && serial.m_centerOfMass == pooled.m_centerOfMass;
+    for (int i = 0; i < 3; ++i) {
+        identical = identical && serial.m_inertia[i] == pooled.m_inertia[i];
+    }
+    if (!identical) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : density results depend on the number of threads" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "expected mass = " << expected.m_mass << "  measured mass = " << mesh.m_mass << std::endl;
+    printMatrix("expected inertia", expected.m_inertia);
+    printMatrix("computed inertia", mesh.m_inertia);
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testTaskExecutors() {
+    // verify that the executors cover every index exactly once, survive nested calls, and
+    // that work routed through the default executor gives the same answer as one thread
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    const uint32_t COUNT = 100003;
+    const uint32_t GRAIN = 97;
+    ThreadPoolExecutor pool(4);
+    std::atomic<uint32_t> numSerialCalls(0);
+    CallbackExecutor callback([&](uint32_t count, uint32_t grain, const RangeFunction& body) {
+        // an engine would hand these to its jobs; run them back to front to shake out any
+        // dependence on order
+        ++numSerialCalls;
+        uint32_t numRanges = (count + grain - 1) / grain;
+        for (uint32_t i = numRanges; i > 0; --i) {
+            uint32_t begin = (i - 1) * grain;
+            body(begin, (count - begin > grain) ? begin + grain : count);
+        }
+    }, 1);
+    std::vector<TaskExecutor*> executors = { &pool, &callback };
+#ifdef _OPENMP
+    OpenMpExecutor openMp;
+    executors.push_back(&openMp);
+#endif // _OPENMP
+
+    for (uint32_t e = 0; e < executors.size(); ++e) {
+        std::vector<std::atomic<uint32_t>> visits(COUNT);
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            visits[i] = 0;
+        }
+        std::atomic<uint32_t> numLongRanges(0);
+        std::atomic<uint32_t> numNestedVisits(0);
+        parallelFor(COUNT, GRAIN, [&](uint32_t begin, uint32_t end) {
+            if (end - begin > GRAIN) {
+                ++numLongRanges;
+            }
+            for (uint32_t i = begin; i < end; ++i) {
+                ++visits[i];
+            }
+            if (begin == 0) {
+                executors[e]->parallelFor(10, 1, [&](uint32_t nestedBegin, uint32_t nestedEnd) {
+                    if (nestedEnd - nestedBegin > 1) {
+                        ++numLongRanges;
+                    }
+                    numNestedVisits += nestedEnd - nestedBegin;
+                });
+            }
+        }, *executors[e]);
+        uint32_t numBadIndices = 0;
+        for (uint32_t i = 0; i < COUNT; ++i) {
+            if (visits[i] != 1) {
+                ++numBadIndices;
+            }
+        }
+        if (numBadIndices > 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : executor " << e << " visited "
+                << numBadIndices << " indices other than once" << std::endl;
+        }
+        if (numLongRanges > 0) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : executor " << e << " ran "
+                << numLongRanges << " ranges longer than the grain" << std::endl;
+        }
+        if (numNestedVisits != 10) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : executor " << e << " nested loop visited "
+                << numNestedVisits << " indices instead of 10" << std::endl;
+        }
+    }
+
+    // A loop started from inside a pool body must be shared with the idle workers rather than
+    // run on the calling thread alone: its two ranges wait for each other, which only works if
+    // they run at the same time.
+    std::atomic<uint32_t> numArrived(0);
+    std::atomic<uint32_t> numMet(0);
+    pool.parallelFor(2, 1, [&](uint32_t begin, uint32_t) {
+        if (begin != 0) {
+            return;
+        }
+        pool.parallelFor(2, 1, [&](uint32_t, uint32_t) {
+            ++numArrived;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (numArrived < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+            if (numArrived >= 2) {
+                ++numMet;
+            }
+        });
+    });
+    if (numMet != 2) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : nested pool loop did not run in parallel" << std::endl;
+    }
+
+    // the point mass sums are combined in a fixed order so every executor must agree exactly
+    std::vector<btScalar> x, y, z, mass;
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < COUNT; ++i) {
+        seed = seed * 1664525 + 1013904223;
+        x.push_back((btScalar)(seed >> 8) / (btScalar)(1 << 24) - 0.5f);
+        y.push_back(x.back() * 0.5f + 3.0f);
+        z.push_back((btScalar)(seed & 0xff) / 256.0f);
+        mass.push_back(1.0f + (btScalar)(i % 7));
+    }
+    btScalar expectedMass;
+    btVector3 expectedCenter;
+    btMatrix3x3 expectedInertia;
+    computePointMassProperties(COUNT, x.data(), y.data(), z.data(), mass.data(), expectedMass, expectedCenter,
+            expectedInertia, 1);
+    numSerialCalls = 0;
+    for (uint32_t e = 0; e < executors.size(); ++e) {
+        setDefaultTaskExecutor(executors[e]);
+        btScalar totalMass;
+        btVector3 center;
+        btMatrix3x3 inertia;
+        computePointMassProperties(COUNT, x.data(), y.data(), z.data(), mass.data(), totalMass, center, inertia);
+        bool same = (totalMass == expectedMass) && (center == expectedCenter);
+        for (uint32_t i = 0; i < 3; ++i) {
+            same = same && (inertia[i] == expectedInertia[i]);
+        }
+        if (!same) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : point masses differ on executor " << e << std::endl;
+        }
+    }
+    setDefaultTaskExecutor(nullptr);
+    if (numSerialCalls == 0) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : default executor was not used" << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "pool concurrency = " << pool.getConcurrency() << "  callback calls = " << numSerialCalls << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+// helper function
+std::string writeTestFile(const std::string& name, const std::string& contents) {
+    // write the contents to a scratch file for the loader tests and return its path
+    std::string path = (std::filesystem::temp_directory_path() / name).string();
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file) {
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+    return path;
+}
+
+void MeshInfoTests::testObjLoader() {
+    // verify groups, face syntax, reopened groups and multi-chunk parsing of OBJ files
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    // (a) tetrahedron A is split around group B, which shares vertex 1; faces use
+    // texture/normal references, a relative index and a quad
+    std::string contents =
+        "# unit tetrahedron\n"
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nv 3 0 0\nv 3 1 0\nv 3 0 1\n"
+        "g A\n"
+        "f 1/1/1 3/2/2 2/3/3\n"
+        "f 1 2 4\n"
+        "g B\n"
+        "f 1 5 6\n"
+        "f 5 7 6 -7\n"
+        "g A\n"
+        "f 1 4 -5\n"
+        "f 2 3 4\n";
+    std::string path = writeTestFile("meshmass_test_groups.obj", contents);
+    std::vector<MeshGroup> groups;
+    std::string error;
+    if (!loadObjMeshGroups(path, groups, error)) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : failed to load OBJ: " << error << std::endl;
+    } else if (groups.size() != 2 || groups[0].name != "A" || groups[1].name != "B") {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : expected groups A and B but got " << groups.size() << std::endl;
+    } else {
+        MeshGroup& tetrahedron = groups[0];
+        MeshTopologyReport report;
+        MeshMassProperties mesh;
+        mesh.computeMassProperties(tetrahedron.points, tetrahedron.triangleIndices, report);
+        if (tetrahedron.points.size() != 4 || !report.isClosedAndConsistent()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : reopened group has " << tetrahedron.points.size()
+                << " points and " << report.m_numBoundaryEdges << " boundary edges" << std::endl;
+        }
+        btScalar error = mesh.m_volume - 1.0f / 6.0f;
+        if (fabsf(error) > acceptableAbsoluteError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of OBJ tetrahedron off by " << error << std::endl;
+        }
+        if (groups[1].points.size() != 4 || groups[1].triangleIndices.size() != 9) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : group B has " << groups[1].points.size()
+                << " points and " << groups[1].triangleIndices.size() / 3 << " triangles" << std::endl;
+        }
+    }
+
+    // (b) malformed input is rejected
+    path = writeTestFile("meshmass_test_bad.obj", "v 0 0 0\nv 1 0 0\nf 1 2\n");
+    if (loadObjMeshGroups(path, groups, error) || error.empty()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : face with two corners was accepted" << std::endl;
+    }
+    path = writeTestFile("meshmass_test_missing.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 9\n");
+    if (loadObjMeshGroups(path, groups, error) || error.empty()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : reference to a missing vertex was accepted" << std::endl;
+    }
+
+    // (c) a file big enough to be split into several chunks, with groups that span chunks,
+    // must parse the same on one thread and on several
+    VectorOfPoints boxPoints;
+    VectorOfIndices boxTriangles;
+    buildBoxMesh(1.0f, 2.0f, 3.0f, boxPoints, boxTriangles);
+    const uint32_t NUM_BOXES = 8000;
+    const uint32_t NUM_GROUPS = 3;
+    contents.clear();
+    char line[128];
+    for (uint32_t box = 0; box < NUM_BOXES; ++box) {
+        if (box % 1000 == 0) {
+            snprintf(line, sizeof(line), "g part%u\n", (box / 1000) % NUM_GROUPS);
+            contents += line;
+        }
+        for (const btVector3& point : boxPoints) {
+            snprintf(line, sizeof(line), "v %.6f %.6f %.6f\n", point[0] + 2.0f * (box % 100), point[1], point[2] + 4.0f * (box / 100));
+            contents += line;
+        }
+        for (uint32_t i = 0; i < boxTriangles.size(); i += 3) {
+            // relative references, as exporters that write one object at a time do
+            snprintf(line, sizeof(line), "f %d %d %d\n", (int)boxTriangles[i] - 8, (int)boxTriangles[i + 1] - 8,
+                (int)boxTriangles[i + 2] - 8);
+            contents += line;
+        }
+    }
+    path = writeTestFile("meshmass_test_large.obj", contents);
+    std::vector<MeshGroup> serialGroups;
+    bool loaded = loadObjMeshGroups(path, serialGroups, error, 1);
+    ThreadPoolExecutor pool(4);
+    setDefaultTaskExecutor(&pool);
+    loaded = loadObjMeshGroups(path, groups, error) && loaded;
+    setDefaultTaskExecutor(nullptr);
+    if (!loaded || groups.size() != NUM_GROUPS || serialGroups.size() != NUM_GROUPS) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : failed to load large OBJ: " << error << std::endl;
+    } else {
+        btScalar totalVolume = 0.0f;
+        for (uint32_t i = 0; i < NUM_GROUPS; ++i) {
+            if (groups[i].name != serialGroups[i].name || groups[i].points != serialGroups[i].points
+                    || groups[i].triangleIndices != serialGroups[i].triangleIndices) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : group " << i << " differs between threaded and serial parse" << std::endl;
+            }
+            MeshMassProperties mesh(groups[i].points, groups[i].triangleIndices);
+            totalVolume += mesh.m_volume;
+        }
+        btScalar error = (totalVolume - 6.0f * NUM_BOXES) / (6.0f * NUM_BOXES);
+        if (fabsf(error) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of large OBJ off by " << error << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "large OBJ bytes = " << contents.size() << "  groups = " << groups.size() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+// helper function
+void appendLittleEndian(std::string& bytes, const void* data, size_t size) {
+    // the tests assume a little-endian host, as do the binary formats they write
+    bytes.append((const char*)data, size);
+}
+
+void MeshInfoTests::testStlLoader() {
+    // verify binary and ASCII STL files load as the same soup, that a binary header starting
+    // with "solid" is still read as binary, that bad files are rejected, and that a flat mesh
+    // yields finite results
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    MeshMassProperties expectedMesh(points, triangles);
+    uint32_t numFacets = triangles.size() / 3;
+
+    std::string binary(80, ' ');
+    binary.replace(0, 11, "solid box  ");
+    appendLittleEndian(binary, &numFacets, sizeof(numFacets));
+    std::string ascii = "solid box\n";
+    char line[128];
+    for (uint32_t i = 0; i < numFacets; ++i) {
+        float normal[3] = { 0.0f, 0.0f, 0.0f };
+        appendLittleEndian(binary, normal, sizeof(normal));
+        ascii += "  facet normal 0 0 0\n    outer loop\n";
+        for (uint32_t j = 0; j < 3; ++j) {
+            const btVector3& point = points[triangles[3 * i + j]];
+            float xyz[3] = { (float)point[0], (float)point[1], (float)point[2] };
+            appendLittleEndian(binary, xyz, sizeof(xyz));
+            snprintf(line, sizeof(line), "      vertex %g %g %e\n", xyz[0], xyz[1], xyz[2]);
+            ascii += line;
+        }
+        uint16_t attribute = 0;
+        appendLittleEndian(binary, &attribute, sizeof(attribute));
+        ascii += "    endloop\n  endfacet\n";
+    }
+    ascii += "endsolid box\n";
+
+    // the word "vertex" inside a solid name, or as a later word of it, is not a vertex record
+    std::string named = ascii;
+    std::string solidLine = "solid box";
+    std::string endSolidLine = "endsolid box";
+    named.replace(0, solidLine.size(), "solid vertexbox vertex 9 9 9");
+    named.replace(named.rfind(endSolidLine), endSolidLine.size(), "endsolid vertexbox vertex 9 9 9");
+
+    const char* names[3] = { "meshmass_test_binary.stl", "meshmass_test_ascii.stl", "meshmass_test_named.stl" };
+    const std::string* contents[3] = { &binary, &ascii, &named };
+    for (uint32_t k = 0; k < 3; ++k) {
+        VectorOfPoints soup;
+        std::string error;
+        if (!loadStlTriangleSoup(writeTestFile(names[k], *contents[k]), soup, error)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : failed to load " << names[k] << ": " << error << std::endl;
+            continue;
+        }
+        VectorOfPoints weldedPoints;
+        VectorOfIndices weldedTriangles;
+        weldTriangleSoup(soup, 0.0f, weldedPoints, weldedTriangles);
+        MeshTopologyReport report;
+        MeshMassProperties mesh;
+        mesh.computeMassProperties(weldedPoints, weldedTriangles, report);
+        if (soup.size() != triangles.size() || weldedPoints.size() != points.size() || !report.isClosedAndConsistent()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << names[k] << " read " << soup.size()
+                << " soup points that weld to " << weldedPoints.size() << std::endl;
+        }
+        btScalar volumeError = (mesh.m_volume - expectedMesh.m_volume) / expectedMesh.m_volume;
+        if (fabsf(volumeError) > acceptableRelativeError) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : volume of " << names[k] << " off by " << volumeError << std::endl;
+        }
+    }
+
+    // bad input: truncated binary (and so not ASCII either), ASCII with a broken vertex,
+    // ASCII with a partial facet
+    const char* badNames[3] = { "meshmass_test_truncated.stl", "meshmass_test_badvertex.stl", "meshmass_test_partial.stl" };
+    std::string badContents[3] = {
+        std::string("\0\0", 2) + binary.substr(0, binary.size() - 10),
+        "solid bad\n facet normal 0 0 1\n outer loop\n vertex 0 0 zero\n",
+        "solid bad\n vertex 0 0 0\n vertex 1 0 0\n" };
+    for (uint32_t k = 0; k < 3; ++k) {
+        VectorOfPoints soup;
+        std::string error;
+        if (loadStlTriangleSoup(writeTestFile(badNames[k], badContents[k]), soup, error) || error.empty()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << badNames[k] << " was accepted" << std::endl;
+        }
+    }
+
+    // a flat square given from both sides loads fine but encloses nothing
+    VectorOfPoints flatPoints = { btVector3(1.0f, 1.0f, 1.0f), btVector3(2.0f, 1.0f, 1.0f),
+        btVector3(2.0f, 2.0f, 1.0f), btVector3(1.0f, 2.0f, 1.0f) };
+    VectorOfIndices flatTriangles = { 0, 1, 2, 0, 2, 3, 0, 2, 1, 0, 3, 2 };
+    MeshMassProperties flat(flatPoints, flatTriangles);
+    bool finite = std::isfinite(flat.m_volume);
+    for (int i = 0; i < 3; ++i) {
+        finite = finite && std::isfinite(flat.m_centerOfMass[i]);
+        for (int j = 0; j < 3; ++j) {
+            finite = finite && std::isfinite(flat.m_inertia[i][j]);
+        }
+    }
+    if (flat.m_volume != 0.0f || !finite) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : flat mesh gave volume " << flat.m_volume
+            << " and center " << flat.m_centerOfMass[0] << std::endl;
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "binary STL bytes = " << binary.size() << "  ASCII STL bytes = " << ascii.size() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+void MeshInfoTests::testPlyLoader() {
+    // verify binary and ASCII PLY boxes made of quads, with extra interleaved properties and a
+    // header longer than 64KB, and that truncated or big-endian files are rejected
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    btVector3 shift(1.0f, -2.0f, 3.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += shift;
+    }
+    MeshMassProperties expectedMesh(points, triangles);
+
+    // buildBoxMesh() lists each face as two triangles {a, b, d}, {b, c, d}: rebuild the quads
+    // a, b, c, d
+    std::vector<uint32_t> quads;
+    for (uint32_t i = 0; i < triangles.size(); i += 6) {
+        quads.push_back(triangles[i]);
+        quads.push_back(triangles[i + 1]);
+        quads.push_back(triangles[i + 4]);
+        quads.push_back(triangles[i + 2]);
+    }
+
+    std::string comments;
+    while (comments.size() < 70000) {
+        comments += "comment this line pads the header past the old 64KB limit\n";
+    }
+    auto buildHeader = [&](const char* format) {
+        return std::string("ply\nformat ") + format + " 1.0\n" + comments
+            + "element vertex 8\nproperty float x\nproperty float nx\nproperty double y\nproperty uchar red\nproperty float z\n"
+            + "element face 6\nproperty list uchar int vertex_indices\nproperty float quality\nend_header\n";
+    };
+
+    std::string binary = buildHeader("binary_little_endian");
+    std::string ascii = buildHeader("ascii");
+    char line[256];
+    for (const btVector3& point : points) {
+        float x = point[0];
+        float nx = 0.0f;
+        double y = point[1];
+        uint8_t red = 255;
+        float z = point[2];
+        appendLittleEndian(binary, &x, sizeof(x));
+        appendLittleEndian(binary, &nx, sizeof(nx));
+        appendLittleEndian(binary, &y, sizeof(y));
+        appendLittleEndian(binary, &red, sizeof(red));
+        appendLittleEndian(binary, &z, sizeof(z));
+        snprintf(line, sizeof(line), "%g 0 %.17g 255 %g\n", x, y, z);
+        ascii += line;
+    }
+    for (uint32_t i = 0; i < quads.size(); i += 4) {
+        uint8_t count = 4;
+        int32_t indices[4] = { (int32_t)quads[i], (int32_t)quads[i + 1], (int32_t)quads[i + 2], (int32_t)quads[i + 3] };
+        float quality = 0.5f;
+        appendLittleEndian(binary, &count, sizeof(count));
+        appendLittleEndian(binary, indices, sizeof(indices));
+        appendLittleEndian(binary, &quality, sizeof(quality));
+        snprintf(line, sizeof(line), "4 %d %d %d %d 0.5\n", indices[0], indices[1], indices[2], indices[3]);
+        ascii += line;
+    }
+
+    const char* names[2] = { "meshmass_test_binary.ply", "meshmass_test_ascii.ply" };
+    const std::string* contents[2] = { &binary, &ascii };
+    for (uint32_t k = 0; k < 2; ++k) {
+        MeshMassProperties mesh;
+        uint32_t numTriangles = 0;
+        std::string error;
+        if (!computePlyMassProperties(writeTestFile(names[k], *contents[k]), mesh, numTriangles, error)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : failed to load " << names[k] << ": " << error << std::endl;
+            continue;
+        }
+        if (numTriangles != 12) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << names[k] << " gave " << numTriangles << " triangles" << std::endl;
+        }
+        compareMassProperties(names[k], expectedMesh, mesh, acceptableRelativeError, __LINE__);
+    }
+
+    // element counts whose size in bytes overflows 64 bits, for the vertices and for an element
+    // that is skipped, followed by one vertex and a face with far-away indices
+    std::string hugeRecords;
+    float hugeXyz[3] = { 1.0f, 2.0f, 3.0f };
+    appendLittleEndian(hugeRecords, hugeXyz, sizeof(hugeXyz));
+    uint8_t hugeCount = 3;
+    int32_t hugeIndices[3] = { 100000000, 100000001, 100000002 };
+    appendLittleEndian(hugeRecords, &hugeCount, sizeof(hugeCount));
+    appendLittleEndian(hugeRecords, hugeIndices, sizeof(hugeIndices));
+    std::string hugeVertices = std::string("ply\nformat binary_little_endian 1.0\n")
+        + "element vertex 4611686018427387904\nproperty float x\nproperty float y\nproperty float z\n"
+        + "element face 1\nproperty list uchar int vertex_indices\nend_header\n" + hugeRecords;
+    std::string hugeSkipped = std::string("ply\nformat binary_little_endian 1.0\n")
+        + "element junk 4611686018427387904\nproperty float a\n"
+        + "element vertex 1\nproperty float x\nproperty float y\nproperty float z\n"
+        + "element face 1\nproperty list uchar int vertex_indices\nend_header\n" + hugeRecords;
+
+    // bad input: the binary box cut inside the last face's scalar property, or inside its
+    // index list; the ASCII box missing its last number; a big-endian header; the huge counts
+    const uint32_t NUM_BAD_FILES = 6;
+    const char* badNames[NUM_BAD_FILES] = { "meshmass_test_cut_scalar.ply", "meshmass_test_cut_list.ply",
+        "meshmass_test_cut_ascii.ply", "meshmass_test_big_endian.ply", "meshmass_test_huge_vertices.ply",
+        "meshmass_test_huge_skipped.ply" };
+    std::string badContents[NUM_BAD_FILES] = {
+        binary.substr(0, binary.size() - 2),
+        binary.substr(0, binary.size() - 10),
+        ascii.substr(0, ascii.size() - 5),
+        buildHeader("binary_big_endian"),
+        hugeVertices,
+        hugeSkipped };
+    for (uint32_t k = 0; k < NUM_BAD_FILES; ++k) {
+        MeshMassProperties mesh;
+        uint32_t numTriangles = 0;
+        std::string error;
+        if (computePlyMassProperties(writeTestFile(badNames[k], badContents[k]), mesh, numTriangles, error) || error.empty()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << badNames[k] << " was accepted" << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "binary PLY bytes = " << binary.size() << "  ASCII PLY bytes = " << ascii.size() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
+// helper function
+std::string encodeBase64(const std::string& bytes) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    for (size_t i = 0; i < bytes.size(); i += 3) {
+        uint32_t group = (uint32_t)(uint8_t)bytes[i] << 16;
+        if (i + 1 < bytes.size()) {
+            group |= (uint32_t)(uint8_t)bytes[i + 1] << 8;
+        }
+        if (i + 2 < bytes.size()) {
+            group |= (uint32_t)(uint8_t)bytes[i + 2];
+        }
+        text += alphabet[(group >> 18) & 63];
+        text += alphabet[(group >> 12) & 63];
+        text += (i + 1 < bytes.size()) ? alphabet[(group >> 6) & 63] : '=';
+        text += (i + 2 < bytes.size()) ? alphabet[group & 63] : '=';
+    }
+    return text;
+}
+
+void MeshInfoTests::testGltfLoader() {
+    // verify a .gltf with an embedded buffer is read through its default scene, through its root
+    // nodes when it has no scenes, and mesh by mesh when it has no nodes, and that accessors
+    // without a bufferView read as zeros
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << "\n" << __FUNCTION__ << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+
+    VectorOfPoints points;
+    VectorOfIndices triangles;
+    buildBoxMesh(5.0f, 3.0f, 2.0f, points, triangles);
+    btVector3 shift(1.0f, -2.0f, 3.0f);
+    for (uint32_t i = 0; i < points.size(); ++i) {
+        points[i] += shift;
+    }
+    MeshMassProperties box(points, triangles);
+
+    std::string buffer;
+    for (uint32_t index : triangles) {
+        uint16_t shortIndex = (uint16_t)index;
+        appendLittleEndian(buffer, &shortIndex, sizeof(shortIndex));
+    }
+    size_t indexBytes = buffer.size();
+    for (const btVector3& point : points) {
+        float xyz[3] = { point[0], point[1], point[2] };
+        appendLittleEndian(buffer, xyz, sizeof(xyz));
+    }
+
+    // the box mesh carries two more primitives: three zero positions, and six zero indices
+    // into the box positions, which add degenerate triangles and no volume
+    std::string common = std::string("\"asset\":{\"version\":\"2.0\"},")
+        + "\"buffers\":[{\"byteLength\":" + std::to_string(buffer.size())
+        + ",\"uri\":\"data:application/octet-stream;base64," + encodeBase64(buffer) + "\"}],"
+        + "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(indexBytes) + "},"
+        + "{\"buffer\":0,\"byteOffset\":" + std::to_string(indexBytes)
+        + ",\"byteLength\":" + std::to_string(buffer.size() - indexBytes) + "}],"
+        + "\"accessors\":[{\"bufferView\":1,\"componentType\":5126,\"count\":" + std::to_string(points.size()) + ",\"type\":\"VEC3\"},"
+        + "{\"bufferView\":0,\"componentType\":5123,\"count\":" + std::to_string(triangles.size()) + ",\"type\":\"SCALAR\"},"
+        + "{\"componentType\":5126,\"count\":3,\"type\":\"VEC3\"},"
+        + "{\"componentType\":5123,\"count\":6,\"type\":\"SCALAR\"}],"
+        + "\"meshes\":[{\"name\":\"box\",\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1},"
+        + "{\"attributes\":{\"POSITION\":2}},{\"attributes\":{\"POSITION\":0},\"indices\":3}]}]";
+    std::string nodes = ",\"nodes\":[{\"name\":\"parent\",\"mesh\":0,\"translation\":[1,2,3],\"children\":[1]},"
+        "{\"name\":\"child\",\"mesh\":0,\"translation\":[10,0,0]}]";
+    std::string withScene = "{" + common + nodes + ",\"scene\":0,\"scenes\":[{\"nodes\":[0]}]}";
+    std::string withoutScenes = "{" + common + nodes + "}";
+    std::string withoutNodes = "{" + common + "}";
+
+    btMatrix3x3 identity;
+    identity.setIdentity();
+    MeshMassProperties parent = box;
+    transformMassProperties(parent, identity, btVector3(1.0f, 2.0f, 3.0f));
+    MeshMassProperties child = box;
+    transformMassProperties(child, identity, btVector3(11.0f, 2.0f, 3.0f));
+
+    const char* names[3] = { "meshmass_test_scene.gltf", "meshmass_test_no_scenes.gltf", "meshmass_test_no_nodes.gltf" };
+    const std::string* contents[3] = { &withScene, &withoutScenes, &withoutNodes };
+    for (uint32_t k = 0; k < 3; ++k) {
+        std::vector<GltfMeshInstance> instances;
+        std::string error;
+        if (!computeGltfMassProperties(writeTestFile(names[k], *contents[k]), instances, error)) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : failed to load " << names[k] << ": " << error << std::endl;
+            continue;
+        }
+        uint32_t expectedInstances = (k < 2) ? 2 : 1;
+        if (instances.size() != expectedInstances) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << names[k] << " gave " << instances.size()
+                << " instances, expected " << expectedInstances << std::endl;
+            continue;
+        }
+        for (const GltfMeshInstance& instance : instances) {
+            if (instance.numTriangles != 15) {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << names[k] << " instance " << instance.name
+                    << " gave " << instance.numTriangles << " triangles" << std::endl;
+            }
+            if (k == 2) {
+                compareMassProperties(names[k], box, instance.properties, acceptableRelativeError, __LINE__);
+            } else if (instance.name == "parent") {
+                compareMassProperties(names[k], parent, instance.properties, acceptableRelativeError, __LINE__);
+            } else if (instance.name == "child") {
+                compareMassProperties(names[k], child, instance.properties, acceptableRelativeError, __LINE__);
+            } else {
+                std::cout << __FILE__ << ":" << __LINE__ << " ERROR : " << names[k] << " gave unexpected instance "
+                    << instance.name << std::endl;
+            }
+        }
+    }
+
+    // an accessor that names a bufferView the document lacks is still an error
+    std::string badView = withoutNodes;
+    badView.replace(badView.find("{\"componentType\":5126"), 1, "{\"bufferView\":7,");
+    std::vector<GltfMeshInstance> instances;
+    std::string error;
+    if (computeGltfMassProperties(writeTestFile("meshmass_test_bad_view.gltf", badView), instances, error) || error.empty()) {
+        std::cout << __FILE__ << ":" << __LINE__ << " ERROR : accessor with a missing bufferView was accepted" << std::endl;
+    }
+
+    // malformed sizes on the position accessor or on the index bufferView: negative, fractional,
+    // too large for the buffer or for 64 bits, and strides outside what the spec allows
+    const uint32_t NUM_MALFORMED = 8;
+    const char* accessorFields[NUM_MALFORMED] = { "\"byteOffset\":-4,", "\"count\":2.5,", "\"count\":4294967296,",
+        "\"byteOffset\":18446744073709551000,", "", "", "", "" };
+    const char* viewFields[NUM_MALFORMED] = { "", "", "", "", "\"byteLength\":1e30,", "\"byteStride\":1,",
+        "\"byteStride\":256,", "\"byteOffset\":-2," };
+    for (uint32_t k = 0; k < NUM_MALFORMED; ++k) {
+        std::string malformed = withoutNodes;
+        std::string accessorStart = "{\"bufferView\":1,";
+        malformed.insert(malformed.find(accessorStart) + accessorStart.size(), accessorFields[k]);
+        std::string viewStart = "\"bufferViews\":[{\"buffer\":0,";
+        malformed.insert(malformed.find(viewStart) + viewStart.size(), viewFields[k]);
+        instances.clear();
+        error.clear();
+        if (computeGltfMassProperties(writeTestFile("meshmass_test_malformed.gltf", malformed), instances, error) || error.empty()) {
+            std::cout << __FILE__ << ":" << __LINE__ << " ERROR : malformed accessor " << k << " was accepted" << std::endl;
+        }
+    }
+
+#ifdef VERBOSE_UNIT_TESTS
+    std::cout << ".gltf bytes = " << withScene.size() << std::endl;
+#endif // VERBOSE_UNIT_TESTS
+}
+
 void MeshInfoTests::runAllTests() {
     testParallelAxisTheorem();
     testTetrahedron();
     testOpenTetrahedonMesh();
 	testClosedTetrahedronMesh();
     testBoxAsMesh();
+    testMeshTopology();
+    testOrientationRepair();
+    testCappedHoles();
+    testWeldTriangleSoup();
+    testMassPropertiesCache();
+    testTransformMassProperties();
+    testQuantizedPoints();
+    testDeterministicMassProperties();
+    testErrorBounds();
+    testStripsAndFans();
+    testPolygons();
+    testPrimitives();
+    testConvexHull();
+    testSkinnedMesh();
+    testMorphTargets();
+    testMeshSequence();
+    testVoxelGrid();
+    testSparseSdf();
+    testPointMasses();
+    testTetrahedra();
+    testDensityPolynomial();
+    testTaskExecutors();
+    testObjLoader();
+    testStlLoader();
+    testPlyLoader();
+    testGltfLoader();
     //testWithCube();
 }
@@ -15,6 +15,32 @@ namespace MeshInfoTests{
     void testOpenTetrahedonMesh();
 	void testClosedTetrahedronMesh();
     void testBoxAsMesh();
+    void testMeshTopology();
+    void testOrientationRepair();
+    void testCappedHoles();
+    void testWeldTriangleSoup();
+    void testMassPropertiesCache();
+    void testTransformMassProperties();
+    void testQuantizedPoints();
+    void testDeterministicMassProperties();
+    void testErrorBounds();
+    void testStripsAndFans();
+    void testPolygons();
+    void testPrimitives();
+    void testConvexHull();
+    void testSkinnedMesh();
+    void testMorphTargets();
+    void testMeshSequence();
+    void testVoxelGrid();
+    void testSparseSdf();
+    void testPointMasses();
+    void testTetrahedra();
+    void testDensityPolynomial();
+    void testTaskExecutors();
+    void testObjLoader();
+    void testStlLoader();
+    void testPlyLoader();
+    void testGltfLoader();
     void runAllTests();
 }
 #endif // MESH_MASS_PROPERTIES_H
@@ -0,0 +1,109 @@
+//
+// MeshSequenceMassProperties.cpp
+//
+// Mass properties of every frame of an animated mesh with fixed topology.
+//
+
+#include "MeshSequenceMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "ParallelFor.h"
+
+void MassPropertiesSeries::resize(uint32_t numFrames) {
+    m_volume.assign(numFrames, 0.0f);
+    m_centerOfMass.assign(3 * numFrames, 0.0f);
+    m_inertia.assign(6 * numFrames, 0.0f);
+    m_valid.assign(numFrames, 0);
+}
+
+void MassPropertiesSeries::setFrame(uint32_t frame, const MeshMassProperties& properties) {
+    m_volume[frame] = properties.m_volume;
+    btScalar* center = &m_centerOfMass[3 * frame];
+    btScalar* inertia = &m_inertia[6 * frame];
+    for (uint32_t k = 0; k < 3; ++k) {
+        center[k] = properties.m_centerOfMass[k];
+        inertia[k] = properties.m_inertia[k][k];
+    }
+    inertia[3] = properties.m_inertia[0][1];
+    inertia[4] = properties.m_inertia[0][2];
+    inertia[5] = properties.m_inertia[1][2];
+    m_valid[frame] = 1;
+}
+
+void MassPropertiesSeries::getFrame(uint32_t frame, MeshMassProperties& properties) const {
+    properties.m_volume = m_volume[frame];
+    properties.m_mass = m_volume[frame];
+    const btScalar* center = &m_centerOfMass[3 * frame];
+    const btScalar* inertia = &m_inertia[6 * frame];
+    properties.m_centerOfMass.setValue(center[0], center[1], center[2]);
+    properties.m_inertia.setValue(inertia[0], inertia[3], inertia[4],
+            inertia[3], inertia[1], inertia[5],
+            inertia[4], inertia[5], inertia[2]);
+}
+
+MeshSequenceMassProperties::MeshSequenceMassProperties(uint32_t numPoints, const VectorOfIndices& triangleIndices) :
+        m_numPoints(numPoints) {
+    // Sort the triangles by their smallest point index so that consecutive triangles gather
+    // from nearby points.  Each triangle keeps its own rotation of corners, so its winding
+    // is unchanged.
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    std::vector<uint64_t> order(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        const uint32_t* triangle = &triangleIndices[3 * i];
+        assert(triangle[0] < numPoints && triangle[1] < numPoints && triangle[2] < numPoints);
+        uint32_t smallest = std::min(triangle[0], std::min(triangle[1], triangle[2]));
+        order[i] = ((uint64_t)smallest << 32) | i;
+    }
+    std::sort(order.begin(), order.end());
+    m_triangleIndices.resize(3 * numTriangles);
+    for (uint32_t i = 0; i < numTriangles; ++i) {
+        uint32_t source = 3 * (uint32_t)order[i];
+        m_triangleIndices[3 * i] = triangleIndices[source];
+        m_triangleIndices[3 * i + 1] = triangleIndices[source + 1];
+        m_triangleIndices[3 * i + 2] = triangleIndices[source + 2];
+    }
+}
+
+void MeshSequenceMassProperties::computeFrame(const btVector3* points, MeshMassProperties& result) const {
+    // indices were validated in the constructor
+    MassPropertiesAccumulator totals;
+    uint32_t numIndices = m_triangleIndices.size();
+    const uint32_t* indices = m_triangleIndices.data();
+    for (uint32_t t = 0; t < numIndices; t += 3) {
+        totals.addTriangle(points[indices[t]], points[indices[t + 1]], points[indices[t + 2]]);
+    }
+    totals.getMassProperties(result);
+}
+
+void MeshSequenceMassProperties::computeFrames(uint32_t numFrames, const FrameLoader& loadFrame,
+        MassPropertiesSeries& series, uint32_t numThreads) const {
+    series.resize(numFrames);
+    parallelFor(numFrames, 1, [&](uint32_t begin, uint32_t end) {
+        VectorOfPoints points;
+        MeshMassProperties result;
+        for (uint32_t frame = begin; frame < end; ++frame) {
+            points.clear();
+            if (loadFrame(frame, points) && points.size() >= m_numPoints) {
+                computeFrame(points.data(), result);
+                series.setFrame(frame, result);
+            }
+        }
+    }, numThreads);
+}
+
+void MeshSequenceMassProperties::computeFrames(const VectorOfPoints& frames, MassPropertiesSeries& series,
+        uint32_t numThreads) const {
+    uint32_t numFrames = (m_numPoints > 0) ? frames.size() / m_numPoints : 0;
+    series.resize(numFrames);
+    parallelFor(numFrames, 1, [&](uint32_t begin, uint32_t end) {
+        MeshMassProperties result;
+        for (uint32_t frame = begin; frame < end; ++frame) {
+            computeFrame(&frames[frame * m_numPoints], result);
+            series.setFrame(frame, result);
+        }
+    }, numThreads);
+}
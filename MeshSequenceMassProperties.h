@@ -0,0 +1,52 @@
+//
+//  MeshSequenceMassProperties.h
+//
+// Mass properties of every frame of an animated mesh with fixed topology.
+
+#ifndef MESH_SEQUENCE_MASS_PROPERTIES_H
+#define MESH_SEQUENCE_MASS_PROPERTIES_H
+
+#include <functional>
+
+#include "MeshMassProperties.h"
+
+// Per-frame results stored as parallel arrays, frame i at index i (times the component count).
+struct MassPropertiesSeries {
+    std::vector<btScalar> m_volume;
+    std::vector<btScalar> m_centerOfMass;   // x, y, z per frame
+    std::vector<btScalar> m_inertia;        // xx, yy, zz, xy, xz, yz per frame (about the center of mass)
+    std::vector<uint8_t> m_valid;           // 0 where the frame could not be loaded
+
+    void resize(uint32_t numFrames);
+    void setFrame(uint32_t frame, const MeshMassProperties& properties);
+    void getFrame(uint32_t frame, MeshMassProperties& properties) const;
+};
+
+// Fills 'points' with the positions of the given frame; returns false when the frame is unavailable.
+typedef std::function<bool(uint32_t frame, VectorOfPoints& points)> FrameLoader;
+
+// Integrates a vertex-cache sequence: many frames of point positions over one triangle list.
+// The triangle list is checked and reordered for cache locality once, in the constructor,
+// instead of once per frame.  Frames are spread over threads, and each thread loads the frame
+// it is about to integrate, so reading one frame overlaps with integrating others.
+class MeshSequenceMassProperties {
+public:
+    MeshSequenceMassProperties(uint32_t numPoints, const VectorOfIndices& triangleIndices);
+
+    // loadFrame is called concurrently from several threads (each with its own buffer) and
+    // must be safe to call that way.  numThreads = 0 uses one thread per hardware core.
+    void computeFrames(uint32_t numFrames, const FrameLoader& loadFrame, MassPropertiesSeries& series,
+            uint32_t numThreads = 0) const;
+
+    // frames already in memory, numPoints per frame back to back
+    void computeFrames(const VectorOfPoints& frames, MassPropertiesSeries& series, uint32_t numThreads = 0) const;
+
+    // integrate one frame of points
+    void computeFrame(const btVector3* points, MeshMassProperties& result) const;
+
+private:
+    uint32_t m_numPoints;
+    VectorOfIndices m_triangleIndices;     // sorted by their smallest index
+};
+
+#endif // MESH_SEQUENCE_MASS_PROPERTIES_H
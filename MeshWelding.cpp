@@ -0,0 +1,305 @@
+//
+// MeshWelding.cpp
+//
+// Utility for turning an unindexed triangle soup into the points + indices form
+// expected by MeshMassProperties.
+//
+
+#include "MeshWelding.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+
+#include "ParallelFor.h"
+
+// The welder works in two passes.  A soup repeats every shared point once per triangle that
+// uses it, so the first pass, run in parallel, collapses bit-identical copies through a
+// concurrent hash table in which each slot keeps the lowest soup index with its key.  The
+// second pass welds only the distinct points, in order of first appearance: each is quantized
+// to a cell of a uniform grid whose cells are 'tolerance' wide, so any earlier point within
+// tolerance must lie in the same cell or one of its 26 neighbors.  Cells are stored in a flat
+// open-addressing hash table; each cell heads a linked list of the welded points that fell
+// inside it.
+
+const uint32_t EMPTY_SLOT = 0xffffffff;
+const uint32_t SOUP_POINTS_PER_CHUNK = 1 << 14;
+
+struct WeldCell {
+    int64_t coords[3];
+    uint32_t firstPoint = EMPTY_SLOT;
+};
+
+// helper function
+uint64_t hashWeldCell(const int64_t* coords) {
+    uint64_t h = (uint64_t)coords[0] * 0x9e3779b97f4a7c15ULL;
+    h ^= (uint64_t)coords[1] * 0xc2b2ae3d27d4eb4fULL;
+    h ^= (uint64_t)coords[2] * 0x165667b19e3779f9ULL;
+    return h ^ (h >> 29);
+}
+
+// helper function
+int64_t quantizeCoordinate(btScalar value, btScalar inverseCellSize) {
+    if (inverseCellSize == 0.0f) {
+        // exact welding: use the bit pattern (adding zero turns -0.0 into +0.0)
+        value += 0.0f;
+        int64_t bits = 0;
+        memcpy(&bits, &value, sizeof(btScalar));
+        return bits;
+    }
+    double cell = floor((double)value * (double)inverseCellSize);
+    const double LIMIT = 4.0e18;
+    if (cell > LIMIT) {
+        cell = LIMIT;
+    } else if (cell < -LIMIT) {
+        cell = -LIMIT;
+    }
+    return (int64_t)cell;
+}
+
+// helper function
+inline void getExactKey(const btVector3& point, uint64_t* key) {
+    // bit patterns of the coordinates, with -0.0 folded into +0.0
+    for (uint32_t k = 0; k < 3; ++k) {
+        btScalar value = point[k] + 0.0f;
+        key[k] = 0;
+        memcpy(&key[k], &value, sizeof(btScalar));
+    }
+}
+
+// helper function
+inline uint32_t hashExactKey(const uint64_t* key) {
+    uint64_t h = (uint64_t)key[0] * 0x9e3779b97f4a7c15ULL;
+    h ^= (uint64_t)key[1] * 0xc2b2ae3d27d4eb4fULL;
+    h ^= (uint64_t)key[2] * 0x165667b19e3779f9ULL;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+// Lock-free table from point bits to the lowest soup index holding them.  Slots are claimed
+// with compare-and-swap and never released; a slot's key is read from the soup point whose
+// index it holds, which is immutable, so lookups need no locks either.
+class ExactPointTable {
+public:
+    ExactPointTable(const VectorOfPoints& soup, uint32_t numPoints) : m_soup(soup) {
+        uint32_t capacity = 16;
+        while (capacity < 2 * numPoints) {
+            capacity *= 2;
+        }
+        m_slots = std::vector<std::atomic<uint32_t>>(capacity);
+        for (std::atomic<uint32_t>& slot : m_slots) {
+            slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+        }
+        m_mask = capacity - 1;
+    }
+
+    void insert(uint32_t index) {
+        uint64_t key[3];
+        getExactKey(m_soup[index], key);
+        uint32_t slot = hashExactKey(key) & m_mask;
+        while (true) {
+            uint32_t current = m_slots[slot].load(std::memory_order_acquire);
+            if (current == EMPTY_SLOT) {
+                if (m_slots[slot].compare_exchange_weak(current, index, std::memory_order_acq_rel)) {
+                    return;
+                }
+                // lost the race: look at this slot again
+                continue;
+            }
+            if (sameKey(current, key)) {
+                // keep the lowest index
+                while (index < current && !m_slots[slot].compare_exchange_weak(current, index, std::memory_order_acq_rel)) {
+                }
+                return;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+    }
+
+    // the lowest index of a point identical to the given one; call after every insert is done
+    uint32_t find(uint32_t index) const {
+        uint64_t key[3];
+        getExactKey(m_soup[index], key);
+        uint32_t slot = hashExactKey(key) & m_mask;
+        while (true) {
+            uint32_t current = m_slots[slot].load(std::memory_order_relaxed);
+            if (current == EMPTY_SLOT || sameKey(current, key)) {
+                return current;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+    }
+
+private:
+    bool sameKey(uint32_t index, const uint64_t* key) const {
+        uint64_t other[3];
+        getExactKey(m_soup[index], other);
+        return other[0] == key[0] && other[1] == key[1] && other[2] == key[2];
+    }
+
+    const VectorOfPoints& m_soup;
+    std::vector<std::atomic<uint32_t>> m_slots;
+    uint32_t m_mask;
+};
+
+class WeldTable {
+public:
+    WeldTable(uint32_t expectedNumPoints) {
+        uint32_t capacity = 16;
+        while (capacity < 2 * expectedNumPoints) {
+            capacity *= 2;
+        }
+        m_cells.resize(capacity);
+        m_mask = capacity - 1;
+        m_numCells = 0;
+    }
+
+    // returns the cell for these coordinates, or NULL when it has not been created
+    const WeldCell* find(const int64_t* coords) const {
+        uint32_t slot = (uint32_t)hashWeldCell(coords) & m_mask;
+        while (m_cells[slot].firstPoint != EMPTY_SLOT) {
+            const WeldCell& cell = m_cells[slot];
+            if (cell.coords[0] == coords[0] && cell.coords[1] == coords[1] && cell.coords[2] == coords[2]) {
+                return &cell;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+        return nullptr;
+    }
+
+    // returns the head of this cell's list, which becomes newPoint; the old head is returned
+    // so the caller can link it behind the new point
+    uint32_t insert(const int64_t* coords, uint32_t newPoint) {
+        uint32_t slot = (uint32_t)hashWeldCell(coords) & m_mask;
+        while (m_cells[slot].firstPoint != EMPTY_SLOT) {
+            WeldCell& cell = m_cells[slot];
+            if (cell.coords[0] == coords[0] && cell.coords[1] == coords[1] && cell.coords[2] == coords[2]) {
+                uint32_t oldHead = cell.firstPoint;
+                cell.firstPoint = newPoint;
+                return oldHead;
+            }
+            slot = (slot + 1) & m_mask;
+        }
+        WeldCell& cell = m_cells[slot];
+        cell.coords[0] = coords[0];
+        cell.coords[1] = coords[1];
+        cell.coords[2] = coords[2];
+        cell.firstPoint = newPoint;
+        ++m_numCells;
+        if (2 * m_numCells > m_cells.size()) {
+            grow();
+        }
+        return EMPTY_SLOT;
+    }
+
+private:
+    void grow() {
+        std::vector<WeldCell> oldCells;
+        oldCells.swap(m_cells);
+        m_cells.resize(2 * oldCells.size());
+        m_mask = m_cells.size() - 1;
+        for (const WeldCell& cell : oldCells) {
+            if (cell.firstPoint != EMPTY_SLOT) {
+                uint32_t slot = (uint32_t)hashWeldCell(cell.coords) & m_mask;
+                while (m_cells[slot].firstPoint != EMPTY_SLOT) {
+                    slot = (slot + 1) & m_mask;
+                }
+                m_cells[slot] = cell;
+            }
+        }
+    }
+
+    std::vector<WeldCell> m_cells;
+    uint32_t m_mask;
+    uint32_t m_numCells;
+};
+
+uint32_t weldTriangleSoup(const VectorOfPoints& soup, btScalar tolerance,
+        VectorOfPoints& points, VectorOfIndices& triangleIndices, uint32_t numThreads) {
+    uint32_t numTriangles = soup.size() / 3;
+    uint32_t numSoupPoints = 3 * numTriangles;
+    points.clear();
+    triangleIndices.clear();
+    points.reserve(numSoupPoints / 2);
+    triangleIndices.reserve(numSoupPoints);
+
+    // first pass: find the first copy of every point
+    ExactPointTable exactTable(soup, numSoupPoints);
+    parallelFor(numSoupPoints, SOUP_POINTS_PER_CHUNK, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            exactTable.insert(i);
+        }
+    }, numThreads);
+    VectorOfIndices firstCopy(numSoupPoints);
+    parallelFor(numSoupPoints, SOUP_POINTS_PER_CHUNK, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            firstCopy[i] = exactTable.find(i);
+        }
+    }, numThreads);
+
+    // second pass: weld the first copies within tolerance, in soup order
+    btScalar inverseCellSize = (tolerance > 0.0f) ? 1.0f / tolerance : 0.0f;
+    btScalar toleranceSquared = tolerance * tolerance;
+    int numNeighbors = (tolerance > 0.0f) ? 1 : 0;
+
+    WeldTable table(numSoupPoints / 2);
+    VectorOfIndices nextPoint;
+    nextPoint.reserve(numSoupPoints / 2);
+    VectorOfIndices welded(numSoupPoints);
+    for (uint32_t i = 0; i < numSoupPoints; ++i) {
+        if (firstCopy[i] != i) {
+            // an identical point came earlier
+            welded[i] = welded[firstCopy[i]];
+            continue;
+        }
+        const btVector3& point = soup[i];
+        int64_t coords[3];
+        for (int k = 0; k < 3; ++k) {
+            coords[k] = quantizeCoordinate(point[k], inverseCellSize);
+        }
+
+        // search this cell and its neighbors for an earlier point within tolerance
+        uint32_t match = EMPTY_SLOT;
+        for (int dx = -numNeighbors; dx <= numNeighbors && match == EMPTY_SLOT; ++dx) {
+            for (int dy = -numNeighbors; dy <= numNeighbors && match == EMPTY_SLOT; ++dy) {
+                for (int dz = -numNeighbors; dz <= numNeighbors && match == EMPTY_SLOT; ++dz) {
+                    int64_t neighbor[3] = { coords[0] + dx, coords[1] + dy, coords[2] + dz };
+                    const WeldCell* cell = table.find(neighbor);
+                    if (!cell) {
+                        continue;
+                    }
+                    for (uint32_t p = cell->firstPoint; p != EMPTY_SLOT; p = nextPoint[p]) {
+                        if ((points[p] - point).length2() <= toleranceSquared) {
+                            match = p;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (match == EMPTY_SLOT) {
+            match = points.size();
+            points.push_back(point);
+            nextPoint.push_back(table.insert(coords, match));
+        }
+        welded[i] = match;
+    }
+
+    uint32_t numDropped = 0;
+    for (uint32_t i = 0; i < numSoupPoints; i += 3) {
+        uint32_t a = welded[i];
+        uint32_t b = welded[i + 1];
+        uint32_t c = welded[i + 2];
+        if (a == b || b == c || c == a) {
+            ++numDropped;
+        } else {
+            triangleIndices.push_back(a);
+            triangleIndices.push_back(b);
+            triangleIndices.push_back(c);
+        }
+    }
+    return numDropped;
+}
@@ -0,0 +1,23 @@
+//
+//  MeshWelding.h
+//
+// Utility for turning an unindexed triangle soup into the points + indices form
+// expected by MeshMassProperties.
+
+#ifndef MESH_WELDING_H
+#define MESH_WELDING_H
+
+#include "MeshMassProperties.h"
+
+// Given a triangle soup (every three consecutive points form one right-hand triangle) merge
+// the points that lie within 'tolerance' of an earlier point.  The output points and
+// triangleIndices describe the same surface with shared vertices, so they can be handed to
+// MeshMassProperties and its topology checks directly.  A tolerance of zero merges only
+// identical points.  Triangles that collapse because two of their corners merged are
+// dropped.  Returns the number of dropped triangles.  Identical copies of a point are found
+// on numThreads threads (0 = one per hardware core) and always map to the same output point;
+// the distinct points are then welded within tolerance on the calling thread.
+uint32_t weldTriangleSoup(const VectorOfPoints& soup, btScalar tolerance,
+        VectorOfPoints& points, VectorOfIndices& triangleIndices, uint32_t numThreads = 0);
+
+#endif // MESH_WELDING_H
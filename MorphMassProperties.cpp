@@ -0,0 +1,397 @@
+//
+// MorphMassProperties.cpp
+//
+// Mass properties of a blend-shape mesh as precomputed polynomials in the blend weights.
+//
+
+#include "MorphMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+// The integrals over the tetrahedron {origin, a, b, c} with det = a.dot(b.cross(c)) are
+//
+//     6 * volume          = det
+//     24 * first moment   = det * s                                   where s = a + b + c
+//     120 * second moment = det * (a a^T + b b^T + c c^T + s s^T)
+//
+// Writing each corner as a = sum(v[i] * A[i]) with v = (1, w[0], w[1], ...), A[0] the base
+// point and A[k + 1] the offset of target k, every term expands multilinearly: det becomes
+// sum(v[i] v[j] v[k] * det(A[i], B[j], C[k])) and so on.  Per triangle only the targets that
+// move one of its corners take part.
+
+typedef std::unordered_map<uint64_t, std::vector<double>> TermMap;
+
+const uint32_t BITS_PER_VARIABLE = 12;
+const uint32_t MAX_NUM_TARGETS = (1 << BITS_PER_VARIABLE) - 2;
+const uint32_t ROW[6] = { 0, 1, 2, 0, 0, 1 };
+const uint32_t COLUMN[6] = { 0, 1, 2, 1, 2, 2 };
+const uint32_t PERMUTATIONS[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 } };
+
+// helper function
+uint64_t packMonomial(const uint32_t* variables, uint32_t degree) {
+    // variables must be in ascending order
+    uint64_t key = 0;
+    for (uint32_t i = 0; i < degree; ++i) {
+        key = (key << BITS_PER_VARIABLE) | variables[i];
+    }
+    return key;
+}
+
+// helper function
+void addTerm(TermMap& terms, uint64_t key, const double* values, uint32_t numComponents) {
+    std::vector<double>& coefficients = terms[key];
+    if (coefficients.empty()) {
+        coefficients.assign(numComponents, 0.0);
+    }
+    for (uint32_t i = 0; i < numComponents; ++i) {
+        coefficients[i] += values[i];
+    }
+}
+
+// helper function
+void flattenTerms(const TermMap& terms, std::vector<uint64_t>& monomials, std::vector<double>& coefficients) {
+    // sorted by monomial so that evaluation order, and with it rounding, is reproducible
+    monomials.clear();
+    monomials.reserve(terms.size());
+    for (const auto& term : terms) {
+        monomials.push_back(term.first);
+    }
+    std::sort(monomials.begin(), monomials.end());
+    coefficients.clear();
+    for (uint64_t monomial : monomials) {
+        const std::vector<double>& values = terms.find(monomial)->second;
+        coefficients.insert(coefficients.end(), values.begin(), values.end());
+    }
+}
+
+MorphMassProperties::MorphMassProperties(const VectorOfPoints& basePoints, const VectorOfIndices& triangleIndices,
+        const std::vector<MorphTarget>& targets) {
+    m_numTargets = targets.size();
+    assert(m_numTargets <= MAX_NUM_TARGETS);
+    uint32_t numPoints = basePoints.size();
+
+    // integrate about the middle of the base mesh to keep the terms small
+    m_reference.setZero();
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        m_reference += basePoints[i];
+    }
+    if (numPoints > 0) {
+        m_reference /= (btScalar)numPoints;
+    }
+
+    // for each point, the (variable, offset) pairs that move it, in compressed rows
+    std::vector<uint32_t> rowStart(numPoints + 1, 0);
+    for (const MorphTarget& target : targets) {
+        assert(target.m_points.size() == target.m_offsets.size());
+        for (uint32_t point : target.m_points) {
+            assert(point < numPoints);
+            ++rowStart[point + 1];
+        }
+    }
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        rowStart[i + 1] += rowStart[i];
+    }
+    std::vector<uint32_t> pointVariables(rowStart[numPoints]);
+    VectorOfPoints pointOffsets(rowStart[numPoints]);
+    std::vector<uint32_t> fill(rowStart.begin(), rowStart.end() - 1);
+    for (uint32_t k = 0; k < m_numTargets; ++k) {
+        const MorphTarget& target = targets[k];
+        for (uint32_t i = 0; i < target.m_points.size(); ++i) {
+            uint32_t slot = fill[target.m_points[i]]++;
+            pointVariables[slot] = k + 1;
+            pointOffsets[slot] = target.m_offsets[i];
+        }
+    }
+
+    TermMap volumeTerms;
+    TermMap firstTerms;
+    TermMap secondTerms;
+    std::vector<uint32_t> variables;
+    std::vector<double> corners[3];     // per variable: x, y, z of the corner's coefficient
+    std::vector<double> dets;
+    std::vector<double> sums;
+    std::vector<double> volume3;
+    std::vector<double> quadratic;
+
+    // Neighboring triangles are usually moved by the same targets, so their coefficients are
+    // summed in dense buffers, one slot per sorted multiset of bufferVariables, and merged into
+    // the maps only when the set of variables changes.
+    std::vector<uint32_t> bufferVariables;
+    std::vector<double> volumeBuffer;
+    std::vector<double> firstBuffer;
+    std::vector<double> secondBuffer;
+    auto flushBuffers = [&]() {
+        uint32_t n = bufferVariables.size();
+        const double* volume = volumeBuffer.data();
+        const double* first = firstBuffer.data();
+        const double* second = secondBuffer.data();
+        uint32_t monomial[5];
+        for (uint32_t i = 0; i < n; ++i) {
+            monomial[0] = bufferVariables[i];
+            for (uint32_t j = i; j < n; ++j) {
+                monomial[1] = bufferVariables[j];
+                for (uint32_t k = j; k < n; ++k) {
+                    monomial[2] = bufferVariables[k];
+                    if (*volume != 0.0) {
+                        addTerm(volumeTerms, packMonomial(monomial, 3), volume, 1);
+                    }
+                    ++volume;
+                    for (uint32_t l = k; l < n; ++l) {
+                        monomial[3] = bufferVariables[l];
+                        if (first[0] != 0.0 || first[1] != 0.0 || first[2] != 0.0) {
+                            addTerm(firstTerms, packMonomial(monomial, 4), first, 3);
+                        }
+                        first += 3;
+                        for (uint32_t m = l; m < n; ++m) {
+                            monomial[4] = bufferVariables[m];
+                            if (second[0] != 0.0 || second[1] != 0.0 || second[2] != 0.0
+                                    || second[3] != 0.0 || second[4] != 0.0 || second[5] != 0.0) {
+                                addTerm(secondTerms, packMonomial(monomial, 5), second, 6);
+                            }
+                            second += 6;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    uint32_t numTriangles = triangleIndices.size() / 3;
+    for (uint32_t t = 0; t < numTriangles; ++t) {
+        const uint32_t* triangle = &triangleIndices[3 * t];
+
+        // the variables that move this triangle, the constant first
+        variables.assign(1, 0);
+        for (uint32_t c = 0; c < 3; ++c) {
+            assert(triangle[c] < numPoints);
+            for (uint32_t slot = rowStart[triangle[c]]; slot < rowStart[triangle[c] + 1]; ++slot) {
+                variables.push_back(pointVariables[slot]);
+            }
+        }
+        std::sort(variables.begin() + 1, variables.end());
+        variables.erase(std::unique(variables.begin(), variables.end()), variables.end());
+        uint32_t n = variables.size();
+        if (variables != bufferVariables) {
+            flushBuffers();
+            bufferVariables = variables;
+            size_t numMonomials3 = (size_t)n * (n + 1) * (n + 2) / 6;
+            size_t numMonomials4 = numMonomials3 * (n + 3) / 4;
+            size_t numMonomials5 = numMonomials4 * (n + 4) / 5;
+            volumeBuffer.assign(numMonomials3, 0.0);
+            firstBuffer.assign(3 * numMonomials4, 0.0);
+            secondBuffer.assign(6 * numMonomials5, 0.0);
+        }
+
+        for (uint32_t c = 0; c < 3; ++c) {
+            corners[c].assign(3 * n, 0.0);
+            btVector3 base = basePoints[triangle[c]] - m_reference;
+            for (uint32_t k = 0; k < 3; ++k) {
+                corners[c][k] = base[k];
+            }
+            for (uint32_t slot = rowStart[triangle[c]]; slot < rowStart[triangle[c] + 1]; ++slot) {
+                uint32_t i = std::lower_bound(variables.begin(), variables.end(), pointVariables[slot]) - variables.begin();
+                for (uint32_t k = 0; k < 3; ++k) {
+                    corners[c][3 * i + k] += pointOffsets[slot][k];
+                }
+            }
+        }
+
+        // det(A[i], B[j], C[k]) for every combination, and s[l] = A[l] + B[l] + C[l]
+        dets.resize(n * n * n);
+        volume3.resize(n * n * n);
+        for (uint32_t i = 0; i < n; ++i) {
+            const double* a = &corners[0][3 * i];
+            for (uint32_t j = 0; j < n; ++j) {
+                const double* b = &corners[1][3 * j];
+                for (uint32_t k = 0; k < n; ++k) {
+                    const double* c = &corners[2][3 * k];
+                    dets[(i * n + j) * n + k] = a[0] * (b[1] * c[2] - b[2] * c[1])
+                        + a[1] * (b[2] * c[0] - b[0] * c[2])
+                        + a[2] * (b[0] * c[1] - b[1] * c[0]);
+                }
+            }
+        }
+        sums.resize(3 * n);
+        for (uint32_t l = 0; l < 3 * n; ++l) {
+            sums[l] = corners[0][l] + corners[1][l] + corners[2][l];
+        }
+
+        // Coefficients of the three polynomials per sorted multiset of variables, so each
+        // monomial is assembled in full and merged into the maps once per triangle:
+        //
+        //     volume3[i j k]  = sum of det(A[p], B[q], C[r]) over the distinct orderings (p q r)
+        //     quadratic[l m]  = the coefficient of v[l] v[m] in a a^T + b b^T + c c^T + s s^T
+        //
+        // and the moments are the products volume3 * s and volume3 * quadratic.
+        for (uint32_t i = 0; i < n; ++i) {
+            for (uint32_t j = i; j < n; ++j) {
+                for (uint32_t k = j; k < n; ++k) {
+                    const uint32_t tuple[3] = { i, j, k };
+                    uint32_t orderings[6];
+                    uint32_t numOrderings = 0;
+                    double sum = 0.0;
+                    for (uint32_t q = 0; q < 6; ++q) {
+                        uint32_t ordering = (tuple[PERMUTATIONS[q][0]] * n + tuple[PERMUTATIONS[q][1]]) * n + tuple[PERMUTATIONS[q][2]];
+                        if (std::find(orderings, orderings + numOrderings, ordering) == orderings + numOrderings) {
+                            orderings[numOrderings++] = ordering;
+                            sum += dets[ordering];
+                        }
+                    }
+                    volume3[(i * n + j) * n + k] = sum;
+                }
+            }
+        }
+        quadratic.resize(6 * n * n);
+        for (uint32_t l = 0; l < n; ++l) {
+            for (uint32_t m = l; m < n; ++m) {
+                for (uint32_t q = 0; q < 6; ++q) {
+                    uint32_t r = ROW[q];
+                    uint32_t c = COLUMN[q];
+                    double value = 0.0;
+                    for (uint32_t e = 0; e < 4; ++e) {
+                        const double* x = (e < 3) ? corners[e].data() : sums.data();
+                        value += x[3 * l + r] * x[3 * m + c];
+                        if (m != l) {
+                            value += x[3 * m + r] * x[3 * l + c];
+                        }
+                    }
+                    quadratic[6 * (l * n + m) + q] = value;
+                }
+            }
+        }
+
+        // Walk the sorted multisets in the order of the dense buffers; a factor is split off
+        // only at the first of a run of equal variables so that each distinct split is counted
+        // once.
+        double* volume = volumeBuffer.data();
+        double* first = firstBuffer.data();
+        double* second = secondBuffer.data();
+        uint32_t v[5];
+        for (v[0] = 0; v[0] < n; ++v[0]) {
+            for (v[1] = v[0]; v[1] < n; ++v[1]) {
+                for (v[2] = v[1]; v[2] < n; ++v[2]) {
+                    *(volume++) += volume3[(v[0] * n + v[1]) * n + v[2]];
+                    for (v[3] = v[2]; v[3] < n; ++v[3]) {
+                        for (uint32_t p = 0; p < 4; ++p) {
+                            if (p > 0 && v[p] == v[p - 1]) {
+                                continue;
+                            }
+                            uint32_t rest[3];
+                            for (uint32_t a = 0, b = 0; a < 4; ++a) {
+                                if (a != p) {
+                                    rest[b++] = v[a];
+                                }
+                            }
+                            double factor = volume3[(rest[0] * n + rest[1]) * n + rest[2]];
+                            for (uint32_t k = 0; k < 3; ++k) {
+                                first[k] += factor * sums[3 * v[p] + k];
+                            }
+                        }
+                        first += 3;
+                        for (v[4] = v[3]; v[4] < n; ++v[4]) {
+                            for (uint32_t p = 0; p < 5; ++p) {
+                                if (p > 0 && v[p] == v[p - 1]) {
+                                    continue;
+                                }
+                                for (uint32_t q = p + 1; q < 5; ++q) {
+                                    if (q > p + 1 && v[q] == v[q - 1]) {
+                                        continue;
+                                    }
+                                    uint32_t rest[3];
+                                    for (uint32_t a = 0, b = 0; a < 5; ++a) {
+                                        if (a != p && a != q) {
+                                            rest[b++] = v[a];
+                                        }
+                                    }
+                                    double factor = volume3[(rest[0] * n + rest[1]) * n + rest[2]];
+                                    if (factor == 0.0) {
+                                        continue;
+                                    }
+                                    const double* pair = &quadratic[6 * (v[p] * n + v[q])];
+                                    for (uint32_t k = 0; k < 6; ++k) {
+                                        second[k] += factor * pair[k];
+                                    }
+                                }
+                            }
+                            second += 6;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    flushBuffers();
+
+    m_volume6.degree = 3;
+    m_volume6.numComponents = 1;
+    flattenTerms(volumeTerms, m_volume6.monomials, m_volume6.coefficients);
+    m_first24.degree = 4;
+    m_first24.numComponents = 3;
+    flattenTerms(firstTerms, m_first24.monomials, m_first24.coefficients);
+    m_second120.degree = 5;
+    m_second120.numComponents = 6;
+    flattenTerms(secondTerms, m_second120.monomials, m_second120.coefficients);
+}
+
+void MorphMassProperties::evaluate(const Polynomial& polynomial, const std::vector<double>& variables, double* values) {
+    const uint64_t MASK = (1 << BITS_PER_VARIABLE) - 1;
+    uint32_t numComponents = polynomial.numComponents;
+    for (uint32_t c = 0; c < numComponents; ++c) {
+        values[c] = 0.0;
+    }
+    uint32_t numMonomials = polynomial.monomials.size();
+    for (uint32_t i = 0; i < numMonomials; ++i) {
+        uint64_t monomial = polynomial.monomials[i];
+        double product = 1.0;
+        for (uint32_t d = 0; d < polynomial.degree; ++d) {
+            product *= variables[monomial & MASK];
+            monomial >>= BITS_PER_VARIABLE;
+        }
+        const double* coefficients = &polynomial.coefficients[i * numComponents];
+        for (uint32_t c = 0; c < numComponents; ++c) {
+            values[c] += product * coefficients[c];
+        }
+    }
+}
+
+void MorphMassProperties::evaluate(const std::vector<btScalar>& weights, MeshMassProperties& result) const {
+    assert(weights.size() >= m_numTargets);
+    std::vector<double> variables(m_numTargets + 1);
+    variables[0] = 1.0;
+    for (uint32_t k = 0; k < m_numTargets; ++k) {
+        variables[k + 1] = weights[k];
+    }
+    double D;
+    double F[3];
+    double S[6];
+    evaluate(m_volume6, variables, &D);
+    evaluate(m_first24, variables, F);
+    evaluate(m_second120, variables, S);
+
+    // volume = D / 6, center = F / (4 D), second moment about center = S / 120 - F F^T / (96 D)
+    double secondMoment[3][3];
+    for (uint32_t q = 0; q < 6; ++q) {
+        uint32_t r = ROW[q];
+        uint32_t c = COLUMN[q];
+        secondMoment[r][c] = secondMoment[c][r] = S[q] / 120.0 - F[r] * F[c] / (96.0 * D);
+    }
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+    result.m_volume = (btScalar)(D / 6.0);
+    result.m_mass = result.m_volume;
+    for (uint32_t k = 0; k < 3; ++k) {
+        result.m_centerOfMass[k] = m_reference[k] + (btScalar)(F[k] / (4.0 * D));
+    }
+    for (uint32_t r = 0; r < 3; ++r) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            result.m_inertia[r][c] = (btScalar)((r == c ? trace : 0.0) - secondMoment[r][c]);
+        }
+    }
+}
+
+uint32_t MorphMassProperties::getNumTerms() const {
+    return m_volume6.monomials.size() + m_first24.monomials.size() + m_second120.monomials.size();
+}
@@ -0,0 +1,58 @@
+//
+//  MorphMassProperties.h
+//
+// Mass properties of a blend-shape mesh as precomputed polynomials in the blend weights.
+
+#ifndef MORPH_MASS_PROPERTIES_H
+#define MORPH_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+// One blend shape, stored sparsely: point m_points[i] moves by m_offsets[i] at full weight.
+struct MorphTarget {
+    VectorOfIndices m_points;
+    VectorOfPoints m_offsets;
+};
+
+// With weights w the points of a blend-shape mesh are base + sum(w[k] * offset[k]), which is
+// linear in w.  Volume is cubic in the points, the first moments quartic and the second
+// moments quintic, so they are polynomials of degree 3, 4 and 5 in the weights.  The
+// constructor integrates the mesh once to find their coefficients; evaluate() then gives the
+// exact mass properties for any weights without visiting the triangles.
+//
+// Only monomials of shapes that overlap on some triangle get coefficients, so the cost of
+// evaluate() (see getNumTerms()) grows with how much the shapes overlap rather than with
+// the number of triangles.  Rigs whose shapes all touch the same triangles approach the
+// dense worst case of O(K^5) terms for K shapes.  The constructor visits each distinct
+// monomial once per triangle, about K^5 / 120 of them for K shapes on that triangle.
+class MorphMassProperties {
+public:
+    MorphMassProperties(const VectorOfPoints& basePoints, const VectorOfIndices& triangleIndices,
+            const std::vector<MorphTarget>& targets);
+
+    // weights has one entry per target
+    void evaluate(const std::vector<btScalar>& weights, MeshMassProperties& result) const;
+
+    // total number of monomials over volume, first and second moments
+    uint32_t getNumTerms() const;
+
+private:
+    // Coefficients of a homogeneous polynomial in (1, w[0], w[1], ...).  Each monomial is the
+    // sorted list of its variables packed 12 bits apiece, with 0 standing for the constant 1
+    // and k + 1 for w[k].
+    struct Polynomial {
+        uint32_t degree;
+        uint32_t numComponents;
+        std::vector<uint64_t> monomials;
+        std::vector<double> coefficients;   // numComponents per monomial
+    };
+    static void evaluate(const Polynomial& polynomial, const std::vector<double>& variables, double* values);
+
+    uint32_t m_numTargets;
+    btVector3 m_reference;      // the integrals are taken about this point
+    Polynomial m_volume6;       // 6 * volume
+    Polynomial m_first24;       // 24 * first moment: x, y, z
+    Polynomial m_second120;     // 120 * second moment: xx, yy, zz, xy, xz, yz
+};
+
+#endif // MORPH_MASS_PROPERTIES_H
@@ -0,0 +1,318 @@
+//
+// ObjMeshLoader.cpp
+//
+// Multithreaded Wavefront OBJ reader that produces MeshMassProperties input.
+//
+
+#include "ObjMeshLoader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <mutex>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "ParallelFor.h"
+
+// The file is split into chunks that end on line boundaries and each chunk is parsed on its
+// own.  The only cross-chunk state in OBJ is the running vertex count (needed to resolve
+// negative, i.e. relative, face references) and the current group name, so each chunk records
+// those locally and they are stitched together once every chunk is done.
+
+const uint32_t MIN_OBJ_CHUNK_SIZE = 1 << 20;
+
+struct ObjGroupMarker {
+    uint32_t firstFace; // index into the chunk's faces
+    std::string name;
+};
+
+struct ObjChunk {
+    std::vector<float> coords;         // x, y, z per vertex
+    std::vector<int64_t> corners;      // vertex references of all faces, back to back
+    std::vector<uint8_t> isRelative;   // per corner: reference is relative to this chunk
+    VectorOfIndices faceSizes;
+    std::vector<ObjGroupMarker> markers;
+    std::string error;
+};
+
+// helper function
+inline const char* skipSpaces(const char* cursor, const char* end) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        ++cursor;
+    }
+    return cursor;
+}
+
+// helper function
+inline const char* parseObjFloat(const char* cursor, const char* end, float& value) {
+    cursor = skipSpaces(cursor, end);
+    if (cursor < end && *cursor == '+') {
+        ++cursor;
+    }
+    std::from_chars_result result = std::from_chars(cursor, end, value);
+    return (result.ec == std::errc()) ? result.ptr : nullptr;
+}
+
+// helper function
+void parseObjChunk(const char* cursor, const char* end, ObjChunk& chunk) {
+    while (cursor < end) {
+        const char* lineEnd = (const char*)memchr(cursor, '\n', end - cursor);
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        const char* line = skipSpaces(cursor, lineEnd);
+        cursor = lineEnd + 1;
+        if (lineEnd - line < 2 || (line[1] != ' ' && line[1] != '\t')) {
+            continue;
+        }
+
+        if (line[0] == 'v') {
+            float x, y, z;
+            const char* next = parseObjFloat(line + 2, lineEnd, x);
+            next = next ? parseObjFloat(next, lineEnd, y) : nullptr;
+            next = next ? parseObjFloat(next, lineEnd, z) : nullptr;
+            if (!next) {
+                chunk.error = "malformed vertex";
+                return;
+            }
+            chunk.coords.push_back(x);
+            chunk.coords.push_back(y);
+            chunk.coords.push_back(z);
+        } else if (line[0] == 'f') {
+            uint32_t numCorners = 0;
+            const char* next = skipSpaces(line + 2, lineEnd);
+            while (next < lineEnd && *next != '\r' && *next != '#') {
+                int64_t reference = 0;
+                std::from_chars_result result = std::from_chars(next, lineEnd, reference);
+                if (result.ec != std::errc() || reference == 0) {
+                    chunk.error = "malformed face";
+                    return;
+                }
+                if (reference < 0) {
+                    chunk.corners.push_back((int64_t)(chunk.coords.size() / 3) + reference);
+                    chunk.isRelative.push_back(1);
+                } else {
+                    chunk.corners.push_back(reference - 1);
+                    chunk.isRelative.push_back(0);
+                }
+                ++numCorners;
+                // skip any texture/normal references
+                next = result.ptr;
+                while (next < lineEnd && *next != ' ' && *next != '\t' && *next != '\r') {
+                    ++next;
+                }
+                next = skipSpaces(next, lineEnd);
+            }
+            if (numCorners < 3) {
+                chunk.error = "face with fewer than three corners";
+                return;
+            }
+            chunk.faceSizes.push_back(numCorners);
+        } else if (line[0] == 'o' || line[0] == 'g') {
+            const char* nameBegin = skipSpaces(line + 2, lineEnd);
+            const char* nameEnd = lineEnd;
+            while (nameEnd > nameBegin && (nameEnd[-1] == '\r' || nameEnd[-1] == ' ' || nameEnd[-1] == '\t')) {
+                --nameEnd;
+            }
+            ObjGroupMarker marker;
+            marker.firstFace = chunk.faceSizes.size();
+            marker.name.assign(nameBegin, nameEnd);
+            chunk.markers.push_back(marker);
+        }
+    }
+}
+
+// A run of consecutive faces of one chunk that all belong to the same group.
+struct ObjFaceRun {
+    uint32_t chunk;
+    uint32_t firstFace;
+    uint32_t endFace;
+    size_t firstCorner; // index into the chunk's corners of the run's first face
+};
+
+const uint32_t UNUSED_OBJ_VERTEX = 0xffffffff;
+
+// helper function
+bool stitchObjGroup(const std::vector<ObjChunk>& chunks, const std::vector<uint32_t>& vertexBase,
+        const std::vector<ObjFaceRun>& runs, VectorOfIndices& localIndex, MeshGroup& group) {
+    // localIndex maps every global vertex to its index in this group, and must hold
+    // UNUSED_OBJ_VERTEX everywhere on entry; the entries this group touched are reset on the way out
+    uint32_t numVertices = vertexBase.back();
+    VectorOfIndices globalIndex;
+    bool valid = true;
+    uint32_t corner[3];
+    for (const ObjFaceRun& run : runs) {
+        const ObjChunk& chunk = chunks[run.chunk];
+        size_t c = run.firstCorner;
+        for (uint32_t f = run.firstFace; f < run.endFace && valid; ++f) {
+            uint32_t faceSize = chunk.faceSizes[f];
+            for (uint32_t k = 0; k < faceSize; ++k, ++c) {
+                int64_t reference = chunk.corners[c] + (chunk.isRelative[c] ? vertexBase[run.chunk] : 0);
+                if (reference < 0 || reference >= numVertices) {
+                    valid = false;
+                    break;
+                }
+                uint32_t vertex = (uint32_t)reference;
+                if (localIndex[vertex] == UNUSED_OBJ_VERTEX) {
+                    localIndex[vertex] = group.points.size();
+                    globalIndex.push_back(vertex);
+                    uint32_t owner = std::upper_bound(vertexBase.begin(), vertexBase.end(), vertex) - vertexBase.begin() - 1;
+                    const float* xyz = &(chunks[owner].coords[3 * (vertex - vertexBase[owner])]);
+                    group.points.push_back(btVector3(xyz[0], xyz[1], xyz[2]));
+                }
+                // fan triangulation: (0, k - 1, k)
+                if (k < 2) {
+                    corner[k] = localIndex[vertex];
+                } else {
+                    corner[2] = localIndex[vertex];
+                    group.triangleIndices.push_back(corner[0]);
+                    group.triangleIndices.push_back(corner[1]);
+                    group.triangleIndices.push_back(corner[2]);
+                    corner[1] = corner[2];
+                }
+            }
+        }
+    }
+    for (uint32_t vertex : globalIndex) {
+        localIndex[vertex] = UNUSED_OBJ_VERTEX;
+    }
+    return valid;
+}
+
+bool loadObjMeshGroups(const std::string& path, std::vector<MeshGroup>& groups, std::string& error,
+        uint32_t numThreads) {
+    groups.clear();
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open file";
+        return false;
+    }
+    const char* data = file.data();
+    size_t size = file.size();
+
+    // split at line boundaries, a few chunks per thread for balance
+    size_t targetChunkSize = size / (4 * (size_t)getParallelConcurrency(numThreads)) + 1;
+    if (targetChunkSize < MIN_OBJ_CHUNK_SIZE) {
+        targetChunkSize = MIN_OBJ_CHUNK_SIZE;
+    }
+    std::vector<size_t> chunkStarts;
+    size_t start = 0;
+    while (start < size) {
+        chunkStarts.push_back(start);
+        size_t end = start + targetChunkSize;
+        if (end >= size) {
+            break;
+        }
+        const char* newline = (const char*)memchr(data + end, '\n', size - end);
+        start = newline ? (size_t)(newline - data) + 1 : size;
+    }
+    chunkStarts.push_back(size);
+    uint32_t numChunks = chunkStarts.size() - 1;
+
+    std::vector<ObjChunk> chunks(numChunks);
+    parallelFor(numChunks, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            parseObjChunk(data + chunkStarts[i], data + chunkStarts[i + 1], chunks[i]);
+        }
+    }, numThreads);
+
+    // stitch: global vertex offset of each chunk
+    std::vector<uint32_t> vertexBase(numChunks + 1, 0);
+    for (uint32_t i = 0; i < numChunks; ++i) {
+        if (!chunks[i].error.empty()) {
+            error = chunks[i].error;
+            return false;
+        }
+        vertexBase[i + 1] = vertexBase[i] + chunks[i].coords.size() / 3;
+    }
+    uint32_t numVertices = vertexBase[numChunks];
+
+    // Walk the group markers in file order and hand each group the runs of faces that fall
+    // under it; a name can be reopened after other groups, so a group may own many runs.
+    std::unordered_map<std::string, uint32_t> groupIndices;
+    std::vector<std::vector<ObjFaceRun>> groupRuns;
+    uint32_t currentGroup = 0;
+    groups.push_back(MeshGroup());
+    groupRuns.push_back(std::vector<ObjFaceRun>());
+    groupIndices[""] = 0;
+    auto switchGroup = [&](const std::string& name) {
+        std::unordered_map<std::string, uint32_t>::iterator itr = groupIndices.find(name);
+        if (itr == groupIndices.end()) {
+            currentGroup = groups.size();
+            groupIndices[name] = currentGroup;
+            groups.push_back(MeshGroup());
+            groups.back().name = name;
+            groupRuns.push_back(std::vector<ObjFaceRun>());
+        } else {
+            currentGroup = itr->second;
+        }
+    };
+    for (uint32_t i = 0; i < numChunks; ++i) {
+        const ObjChunk& chunk = chunks[i];
+        uint32_t numFaces = chunk.faceSizes.size();
+        ObjFaceRun run = { i, 0, 0, 0 };
+        size_t c = 0;
+        uint32_t f = 0;
+        for (const ObjGroupMarker& marker : chunk.markers) {
+            for (; f < marker.firstFace; ++f) {
+                c += chunk.faceSizes[f];
+            }
+            run.endFace = f;
+            if (run.endFace > run.firstFace) {
+                groupRuns[currentGroup].push_back(run);
+            }
+            switchGroup(marker.name);
+            run.firstFace = f;
+            run.firstCorner = c;
+        }
+        run.endFace = numFaces;
+        if (run.endFace > run.firstFace) {
+            groupRuns[currentGroup].push_back(run);
+        }
+    }
+
+    // Each group copies the points its faces reference, in order of first use, remapping them
+    // through a dense table indexed by global vertex.  Groups are stitched in parallel, and each
+    // concurrent range borrows one table, which is returned with every entry unused again.
+    std::vector<VectorOfIndices> freeTables;
+    std::mutex freeTablesMutex;
+    std::atomic<bool> valid(true);
+    parallelFor(groups.size(), 1, [&](uint32_t begin, uint32_t end) {
+        VectorOfIndices localIndex;
+        {
+            std::lock_guard<std::mutex> lock(freeTablesMutex);
+            if (!freeTables.empty()) {
+                localIndex.swap(freeTables.back());
+                freeTables.pop_back();
+            }
+        }
+        if (localIndex.empty()) {
+            localIndex.assign(numVertices, UNUSED_OBJ_VERTEX);
+        }
+        for (uint32_t g = begin; g < end; ++g) {
+            if (!stitchObjGroup(chunks, vertexBase, groupRuns[g], localIndex, groups[g])) {
+                valid = false;
+            }
+        }
+        std::lock_guard<std::mutex> lock(freeTablesMutex);
+        freeTables.push_back(std::move(localIndex));
+    }, numThreads);
+    if (!valid) {
+        error = "face references a missing vertex";
+        groups.clear();
+        return false;
+    }
+
+    // drop groups without faces (e.g. the unnamed group when every face is named)
+    std::vector<MeshGroup> nonEmptyGroups;
+    for (MeshGroup& group : groups) {
+        if (!group.triangleIndices.empty()) {
+            nonEmptyGroups.push_back(std::move(group));
+        }
+    }
+    groups.swap(nonEmptyGroups);
+    return true;
+}
@@ -0,0 +1,29 @@
+//
+//  ObjMeshLoader.h
+//
+// Multithreaded Wavefront OBJ reader that produces MeshMassProperties input.
+
+#ifndef OBJ_MESH_LOADER_H
+#define OBJ_MESH_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include "MeshMassProperties.h"
+
+// One object or group of a multi-part file, with its own compact set of points.
+struct MeshGroup {
+    std::string name;
+    VectorOfPoints points;
+    VectorOfIndices triangleIndices;
+};
+
+// Reads the 'v' and 'f' records of an OBJ file and returns one MeshGroup per distinct 'o'/'g'
+// name, in order of first appearance (faces before any name go to a group named "").
+// Polygons are split into fans.  Texture and normal references are ignored.  The file is
+// mapped and split at line boundaries so that numThreads threads (0 = one per core) parse it
+// at once.  Returns false (with a reason in 'error') on unreadable or malformed input.
+bool loadObjMeshGroups(const std::string& path, std::vector<MeshGroup>& groups, std::string& error,
+        uint32_t numThreads = 0);
+
+#endif // OBJ_MESH_LOADER_H
@@ -0,0 +1,79 @@
+//
+// ParallelFor.cpp
+//
+// Minimal helper for splitting a loop across worker threads.
+//
+
+#include "ParallelFor.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body,
+        uint32_t numThreads) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    if (numThreads != 1) {
+        TaskExecutor* executor = getDefaultTaskExecutor();
+        if (executor) {
+            executor->parallelFor(count, grain, body);
+            return;
+        }
+    }
+    uint32_t numChunks = (count + grain - 1) / grain;
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if (numThreads > numChunks) {
+        numThreads = numChunks;
+    }
+    if (numThreads <= 1) {
+        for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+            uint32_t begin = chunk * grain;
+            body(begin, (count - begin > grain) ? begin + grain : count);
+        }
+        return;
+    }
+
+    std::atomic<uint32_t> nextChunk(0);
+    auto worker = [&]() {
+        uint32_t chunk;
+        while ((chunk = nextChunk++) < numChunks) {
+            uint32_t begin = chunk * grain;
+            uint32_t end = (count - begin > grain) ? begin + grain : count;
+            body(begin, end);
+        }
+    };
+
+    // the calling thread works too
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body,
+        TaskExecutor& executor) {
+    executor.parallelFor(count, grain > 0 ? grain : 1, body);
+}
+
+uint32_t getParallelConcurrency(uint32_t numThreads) {
+    if (numThreads == 1) {
+        return 1;
+    }
+    TaskExecutor* executor = getDefaultTaskExecutor();
+    if (executor) {
+        return executor->getConcurrency();
+    }
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    return numThreads > 0 ? numThreads : 1;
+}
@@ -0,0 +1,32 @@
+//
+//  ParallelFor.h
+//
+// Minimal helper for splitting a loop across worker threads.
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <functional>
+#include <stdint.h>
+
+#include "TaskExecutor.h"
+
+// Calls body(begin, end) over consecutive chunks of [0, count), each at most 'grain' long.
+// The call returns after every chunk has completed.  numThreads = 1 runs the chunks in order
+// on the calling thread.  Otherwise the work goes to the default TaskExecutor when one is
+// installed (numThreads is then ignored) or else to numThreads threads started for this call,
+// 0 meaning one per hardware core; those threads hand out chunks dynamically so threads that
+// finish early pick up more work.  The body must be safe to call concurrently for different
+// chunks.
+void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body,
+        uint32_t numThreads = 0);
+
+// same, on the given executor
+void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& body,
+        TaskExecutor& executor);
+
+// The number of chunks that parallelFor(..., numThreads) expects to run at once, for callers
+// that size their chunks to the available parallelism.
+uint32_t getParallelConcurrency(uint32_t numThreads);
+
+#endif // PARALLEL_FOR_H
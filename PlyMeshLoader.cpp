@@ -0,0 +1,422 @@
+//
+// PlyMeshLoader.cpp
+//
+// Computes mass properties straight from PLY files.
+//
+
+#include "PlyMeshLoader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <sstream>
+#include <vector>
+
+#include "MappedFile.h"
+
+// NOTE: binary values are read with memcpy, which assumes a little-endian host.
+
+enum PlyType {
+    PLY_INVALID = 0,
+    PLY_INT8,
+    PLY_UINT8,
+    PLY_INT16,
+    PLY_UINT16,
+    PLY_INT32,
+    PLY_UINT32,
+    PLY_FLOAT32,
+    PLY_FLOAT64
+};
+
+struct PlyProperty {
+    std::string name;
+    PlyType type = PLY_INVALID;
+    PlyType countType = PLY_INVALID; // valid only for list properties
+};
+
+struct PlyElement {
+    std::string name;
+    uint64_t count = 0;
+    std::vector<PlyProperty> properties;
+};
+
+// helper function
+PlyType parsePlyType(const std::string& name) {
+    if (name == "char" || name == "int8") return PLY_INT8;
+    if (name == "uchar" || name == "uint8") return PLY_UINT8;
+    if (name == "short" || name == "int16") return PLY_INT16;
+    if (name == "ushort" || name == "uint16") return PLY_UINT16;
+    if (name == "int" || name == "int32") return PLY_INT32;
+    if (name == "uint" || name == "uint32") return PLY_UINT32;
+    if (name == "float" || name == "float32") return PLY_FLOAT32;
+    if (name == "double" || name == "float64") return PLY_FLOAT64;
+    return PLY_INVALID;
+}
+
+// helper function
+uint32_t plyTypeSize(PlyType type) {
+    static const uint32_t sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[type];
+}
+
+// helper function
+inline uint32_t readPlyUnsigned(const char* data, PlyType type) {
+    switch (type) {
+        case PLY_INT8: { int8_t v; memcpy(&v, data, 1); return (uint32_t)v; }
+        case PLY_UINT8: { uint8_t v; memcpy(&v, data, 1); return v; }
+        case PLY_INT16: { int16_t v; memcpy(&v, data, 2); return (uint32_t)v; }
+        case PLY_UINT16: { uint16_t v; memcpy(&v, data, 2); return v; }
+        case PLY_INT32: { int32_t v; memcpy(&v, data, 4); return (uint32_t)v; }
+        case PLY_UINT32: { uint32_t v; memcpy(&v, data, 4); return v; }
+        default: return 0xffffffff;
+    }
+}
+
+// helper function
+inline btScalar readPlyScalar(const char* data, PlyType type) {
+    if (type == PLY_FLOAT32) {
+        float v;
+        memcpy(&v, data, 4);
+        return (btScalar)v;
+    }
+    double v;
+    memcpy(&v, data, 8);
+    return (btScalar)v;
+}
+
+// helper function
+bool parsePlyHeader(const char* data, size_t size, std::vector<PlyElement>& elements, size_t& headerSize,
+        bool& isAscii, std::string& error) {
+    // the header has no length limit (long comment and obj_info blocks are common) so look for
+    // the first line that starts with end_header
+    const char* END_HEADER = "end_header";
+    const char* end = nullptr;
+    for (size_t i = 0; i + 10 <= size; ++i) {
+        if (data[i] == 'e' && (i == 0 || data[i - 1] == '\n') && strncmp(data + i, END_HEADER, 10) == 0) {
+            end = data + i + 10;
+            break;
+        }
+    }
+    if (size < 4 || strncmp(data, "ply", 3) != 0 || !end) {
+        error = "not a PLY file";
+        return false;
+    }
+    // skip the line terminator after end_header
+    while (end < data + size && *end != '\n') {
+        ++end;
+    }
+    headerSize = end - data + 1;
+
+    std::istringstream header(std::string(data, end));
+    std::string line;
+    bool formatOk = false;
+    while (std::getline(header, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            words >> format;
+            if (format != "binary_little_endian" && format != "ascii") {
+                error = "big-endian PLY is not supported";
+                return false;
+            }
+            isAscii = (format == "ascii");
+            formatOk = true;
+        } else if (keyword == "element") {
+            PlyElement element;
+            words >> element.name >> element.count;
+            elements.push_back(element);
+        } else if (keyword == "property") {
+            if (elements.empty()) {
+                error = "property before element";
+                return false;
+            }
+            PlyProperty property;
+            std::string typeName;
+            words >> typeName;
+            if (typeName == "list") {
+                std::string countTypeName;
+                words >> countTypeName >> typeName;
+                property.countType = parsePlyType(countTypeName);
+                if (property.countType == PLY_INVALID || property.countType == PLY_FLOAT32 || property.countType == PLY_FLOAT64) {
+                    error = "bad list count type";
+                    return false;
+                }
+            }
+            property.type = parsePlyType(typeName);
+            words >> property.name;
+            if (property.type == PLY_INVALID) {
+                error = "unknown property type " + typeName;
+                return false;
+            }
+            elements.back().properties.push_back(property);
+        }
+    }
+    if (!formatOk) {
+        error = "missing PLY format line";
+        return false;
+    }
+    return true;
+}
+
+// helper function
+inline bool hasPlyRecords(const char* cursor, const char* end, uint64_t count, uint32_t recordSize) {
+    // whether count records of recordSize bytes fit before end, without forming their product
+    return recordSize == 0 || count <= (uint64_t)(end - cursor) / recordSize;
+}
+
+// helper function
+inline const char* parsePlyNumber(const char* cursor, const char* end, double& value) {
+    // next whitespace separated number of an ASCII body, or nullptr when there is none
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+        ++cursor;
+    }
+    if (cursor < end && *cursor == '+') {
+        ++cursor;
+    }
+    std::from_chars_result result = std::from_chars(cursor, end, value);
+    return (result.ec == std::errc()) ? result.ptr : nullptr;
+}
+
+// helper function
+bool computeAsciiPlyMassProperties(const char* cursor, const char* end, const std::vector<PlyElement>& elements,
+        MassPropertiesAccumulator& totals, uint32_t& numTriangles, std::string& error) {
+    // Text can't be read in place, so the vertex coordinates are parsed into a buffer; faces are
+    // still integrated as they are read.
+    VectorOfPoints points;
+    bool foundVertices = false;
+    double value;
+    for (const PlyElement& element : elements) {
+        bool isVertex = element.name == "vertex";
+        bool isFace = element.name == "face";
+        if (isFace && !foundVertices) {
+            error = "face element precedes vertex element";
+            return false;
+        }
+        if (isVertex) {
+            // a vertex takes at least two characters, which bounds what a lying count can reserve
+            points.reserve((size_t)std::min<uint64_t>(element.count, (uint64_t)(end - cursor) / 2));
+            foundVertices = true;
+        }
+        for (uint64_t i = 0; i < element.count; ++i) {
+            btVector3 point(0.0f, 0.0f, 0.0f);
+            uint32_t numCoords = 0;
+            for (const PlyProperty& property : element.properties) {
+                cursor = parsePlyNumber(cursor, end, value);
+                if (!cursor) {
+                    error = "truncated or malformed element " + element.name;
+                    return false;
+                }
+                if (property.countType == PLY_INVALID) {
+                    int axis = (property.name == "x") ? 0 : (property.name == "y") ? 1 : (property.name == "z") ? 2 : -1;
+                    if (isVertex && axis >= 0) {
+                        point[axis] = (btScalar)value;
+                        ++numCoords;
+                    }
+                    continue;
+                }
+                if (isVertex) {
+                    error = "list property in vertex element";
+                    return false;
+                }
+                if (!(value >= 0.0 && value < 4294967296.0)) {
+                    error = "bad list count in element " + element.name;
+                    return false;
+                }
+                uint32_t count = (uint32_t)value;
+                bool isIndices = isFace && (property.name == "vertex_indices" || property.name == "vertex_index");
+                btVector3 corners[2];
+                for (uint32_t k = 0; k < count; ++k) {
+                    cursor = parsePlyNumber(cursor, end, value);
+                    if (!cursor) {
+                        error = "truncated or malformed element " + element.name;
+                        return false;
+                    }
+                    if (!isIndices) {
+                        continue;
+                    }
+                    if (!(value >= 0.0 && value < (double)points.size())) {
+                        error = "face references a missing vertex";
+                        return false;
+                    }
+                    const btVector3& corner = points[(uint32_t)value];
+                    if (k < 2) {
+                        corners[k] = corner;
+                    } else {
+                        totals.addTriangle(corners[0], corners[1], corner);
+                        corners[1] = corner;
+                        ++numTriangles;
+                    }
+                }
+            }
+            if (isVertex) {
+                if (numCoords != 3) {
+                    error = "vertex element lacks x, y, z";
+                    return false;
+                }
+                points.push_back(point);
+            }
+        }
+    }
+    return true;
+}
+
+bool computePlyMassProperties(const std::string& path, MeshMassProperties& result, uint32_t& numTriangles,
+        std::string& error) {
+    numTriangles = 0;
+    MappedFile file;
+    if (!file.open(path)) {
+        error = "cannot open file";
+        return false;
+    }
+    const char* data = file.data();
+    const char* end = data + file.size();
+
+    std::vector<PlyElement> elements;
+    size_t headerSize = 0;
+    bool isAscii = false;
+    if (!parsePlyHeader(data, file.size(), elements, headerSize, isAscii, error)) {
+        return false;
+    }
+    bool foundFaces = false;
+    for (const PlyElement& element : elements) {
+        foundFaces = foundFaces || element.name == "face";
+    }
+    if (!foundFaces) {
+        error = "no face element";
+        return false;
+    }
+
+    MassPropertiesAccumulator totals;
+    if (isAscii) {
+        if (!computeAsciiPlyMassProperties(data + headerSize, end, elements, totals, numTriangles, error)) {
+            return false;
+        }
+        totals.getMassProperties(result);
+        return true;
+    }
+
+    // vertex view, filled in when the vertex element is reached
+    const char* vertexData = nullptr;
+    uint64_t numVertices = 0;
+    uint32_t vertexStride = 0;
+    uint32_t coordOffsets[3] = { 0, 0, 0 };
+    PlyType coordTypes[3] = { PLY_INVALID, PLY_INVALID, PLY_INVALID };
+
+    const char* cursor = data + headerSize;
+    for (const PlyElement& element : elements) {
+        bool hasLists = false;
+        uint32_t fixedSize = 0;
+        for (const PlyProperty& property : element.properties) {
+            hasLists = hasLists || property.countType != PLY_INVALID;
+            fixedSize += plyTypeSize(property.type);
+        }
+
+        if (element.name == "vertex") {
+            if (hasLists) {
+                error = "list property in vertex element";
+                return false;
+            }
+            uint32_t offset = 0;
+            for (const PlyProperty& property : element.properties) {
+                int axis = (property.name == "x") ? 0 : (property.name == "y") ? 1 : (property.name == "z") ? 2 : -1;
+                if (axis >= 0) {
+                    if (property.type != PLY_FLOAT32 && property.type != PLY_FLOAT64) {
+                        error = "vertex coordinates must be float or double";
+                        return false;
+                    }
+                    coordOffsets[axis] = offset;
+                    coordTypes[axis] = property.type;
+                }
+                offset += plyTypeSize(property.type);
+            }
+            if (coordTypes[0] == PLY_INVALID || coordTypes[1] == PLY_INVALID || coordTypes[2] == PLY_INVALID) {
+                error = "vertex element lacks x, y, z";
+                return false;
+            }
+            vertexData = cursor;
+            numVertices = element.count;
+            vertexStride = fixedSize;
+            if (!hasPlyRecords(cursor, end, numVertices, vertexStride)) {
+                error = "truncated vertex data";
+                return false;
+            }
+            cursor += numVertices * vertexStride;
+            continue;
+        }
+
+        bool isFace = element.name == "face";
+        if (!hasLists && !isFace) {
+            // skip fixed-size elements wholesale
+            if (!hasPlyRecords(cursor, end, element.count, fixedSize)) {
+                error = "truncated element " + element.name;
+                return false;
+            }
+            cursor += element.count * fixedSize;
+            continue;
+        }
+        if (isFace && !vertexData) {
+            error = "face element precedes vertex element";
+            return false;
+        }
+
+        // walk variable-size records one property at a time, checking every step against the
+        // end of the file
+        for (uint64_t i = 0; i < element.count; ++i) {
+            for (const PlyProperty& property : element.properties) {
+                uint32_t valueSize = plyTypeSize(property.type);
+                if (property.countType == PLY_INVALID) {
+                    if ((size_t)(end - cursor) < valueSize) {
+                        error = "truncated element " + element.name;
+                        return false;
+                    }
+                    cursor += valueSize;
+                    continue;
+                }
+                uint32_t countSize = plyTypeSize(property.countType);
+                if ((size_t)(end - cursor) < countSize) {
+                    error = "truncated element " + element.name;
+                    return false;
+                }
+                uint32_t count = readPlyUnsigned(cursor, property.countType);
+                cursor += countSize;
+                if (!hasPlyRecords(cursor, end, count, valueSize)) {
+                    error = "truncated element " + element.name;
+                    return false;
+                }
+                if (isFace && (property.name == "vertex_indices" || property.name == "vertex_index")) {
+                    if (property.type == PLY_FLOAT32 || property.type == PLY_FLOAT64) {
+                        error = "face indices must be integers";
+                        return false;
+                    }
+                    // fan about the first corner, reading points in place
+                    btVector3 corners[3];
+                    for (uint32_t k = 0; k < count; ++k) {
+                        uint32_t index = readPlyUnsigned(cursor + k * valueSize, property.type);
+                        if (index >= numVertices) {
+                            error = "face references a missing vertex";
+                            return false;
+                        }
+                        const char* vertex = vertexData + (size_t)index * vertexStride;
+                        btVector3 point(readPlyScalar(vertex + coordOffsets[0], coordTypes[0]),
+                                readPlyScalar(vertex + coordOffsets[1], coordTypes[1]),
+                                readPlyScalar(vertex + coordOffsets[2], coordTypes[2]));
+                        if (k < 2) {
+                            corners[k] = point;
+                        } else {
+                            totals.addTriangle(corners[0], corners[1], point);
+                            corners[1] = point;
+                            ++numTriangles;
+                        }
+                    }
+                }
+                cursor += (size_t)count * valueSize;
+            }
+        }
+    }
+
+    totals.getMassProperties(result);
+    return true;
+}
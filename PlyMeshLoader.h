@@ -0,0 +1,23 @@
+//
+//  PlyMeshLoader.h
+//
+// Computes mass properties straight from PLY files.
+
+#ifndef PLY_MESH_LOADER_H
+#define PLY_MESH_LOADER_H
+
+#include <string>
+
+#include "MeshMassProperties.h"
+
+// Integrates the faces of a PLY file without building VectorOfIndices.  The file is mapped and
+// in binary little-endian files the vertex element is read in place as a strided view of its
+// x, y, z properties (float or double), whatever other properties are interleaved; ASCII
+// files have their coordinates parsed into a buffer first.  Faces come from the
+// 'vertex_indices' (or 'vertex_index') list property; polygons are split into fans as they are
+// read.  On success 'numTriangles' holds the number of triangles integrated.  Returns false
+// (with a reason in 'error') for big-endian files and malformed or truncated input.
+bool computePlyMassProperties(const std::string& path, MeshMassProperties& result, uint32_t& numTriangles,
+        std::string& error);
+
+#endif // PLY_MESH_LOADER_H
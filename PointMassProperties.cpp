@@ -0,0 +1,183 @@
+//
+// PointMassProperties.cpp
+//
+// Mass properties of clouds of weighted points, e.g. particle and granular bodies.
+//
+
+#include "PointMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "ParallelFor.h"
+
+// points summed by one thread at a time
+const uint32_t POINTS_PER_CHUNK = 16384;
+
+// Mass, first moment and second moment (xx, yy, zz, xy, xz, yz) about a pivot.
+struct PointMoments {
+    double mass = 0.0;
+    double first[3] = { 0.0, 0.0, 0.0 };
+    double second[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+    void add(const PointMoments& other) {
+        mass += other.mass;
+        for (uint32_t k = 0; k < 3; ++k) {
+            first[k] += other.first[k];
+        }
+        for (uint32_t k = 0; k < 6; ++k) {
+            second[k] += other.second[k];
+        }
+    }
+
+    // center of mass and inertia about it: C = second - mass * c c^T, inertia = trace(C) * E - C
+    void finish(const double* pivot, double* center, double* inertia) const {
+        if (mass == 0.0) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                center[k] = pivot[k];
+            }
+            for (uint32_t k = 0; k < 6; ++k) {
+                inertia[k] = 0.0;
+            }
+            return;
+        }
+        double c[3] = { first[0] / mass, first[1] / mass, first[2] / mass };
+        double xx = second[0] - mass * c[0] * c[0];
+        double yy = second[1] - mass * c[1] * c[1];
+        double zz = second[2] - mass * c[2] * c[2];
+        inertia[0] = yy + zz;
+        inertia[1] = zz + xx;
+        inertia[2] = xx + yy;
+        inertia[3] = -(second[3] - mass * c[0] * c[1]);
+        inertia[4] = -(second[4] - mass * c[0] * c[2]);
+        inertia[5] = -(second[5] - mass * c[1] * c[2]);
+        for (uint32_t k = 0; k < 3; ++k) {
+            center[k] = pivot[k] + c[k];
+        }
+    }
+};
+
+// helper function
+void sumPointMoments(uint32_t begin, uint32_t end, const btScalar* x, const btScalar* y, const btScalar* z,
+        const btScalar* mass, const double* pivot, PointMoments& moments) {
+    // plain sums over the arrays so the loop can be vectorized
+    double m = 0.0, mx = 0.0, my = 0.0, mz = 0.0;
+    double mxx = 0.0, myy = 0.0, mzz = 0.0, mxy = 0.0, mxz = 0.0, myz = 0.0;
+    for (uint32_t i = begin; i < end; ++i) {
+        double w = mass[i];
+        double dx = x[i] - pivot[0];
+        double dy = y[i] - pivot[1];
+        double dz = z[i] - pivot[2];
+        m += w;
+        mx += w * dx;
+        my += w * dy;
+        mz += w * dz;
+        mxx += w * dx * dx;
+        myy += w * dy * dy;
+        mzz += w * dz * dz;
+        mxy += w * dx * dy;
+        mxz += w * dx * dz;
+        myz += w * dy * dz;
+    }
+    moments.mass += m;
+    moments.first[0] += mx;
+    moments.first[1] += my;
+    moments.first[2] += mz;
+    moments.second[0] += mxx;
+    moments.second[1] += myy;
+    moments.second[2] += mzz;
+    moments.second[3] += mxy;
+    moments.second[4] += mxz;
+    moments.second[5] += myz;
+}
+
+void computePointMassProperties(uint32_t count, const btScalar* x, const btScalar* y, const btScalar* z,
+        const btScalar* mass, btScalar& totalMass, btVector3& centerOfMass, btMatrix3x3& inertia,
+        uint32_t numThreads) {
+    double pivot[3] = { 0.0, 0.0, 0.0 };
+    if (count > 0) {
+        pivot[0] = x[0];
+        pivot[1] = y[0];
+        pivot[2] = z[0];
+    }
+    uint32_t numChunks = (count + POINTS_PER_CHUNK - 1) / POINTS_PER_CHUNK;
+    std::vector<PointMoments> chunkMoments(numChunks);
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            uint32_t begin = chunk * POINTS_PER_CHUNK;
+            uint32_t end = (count - begin > POINTS_PER_CHUNK) ? begin + POINTS_PER_CHUNK : count;
+            sumPointMoments(begin, end, x, y, z, mass, pivot, chunkMoments[chunk]);
+        }
+    }, numThreads);
+    PointMoments moments;
+    for (const PointMoments& chunk : chunkMoments) {
+        moments.add(chunk);
+    }
+
+    double center[3];
+    double values[6];
+    moments.finish(pivot, center, values);
+    totalMass = (btScalar)moments.mass;
+    centerOfMass.setValue((btScalar)center[0], (btScalar)center[1], (btScalar)center[2]);
+    inertia.setValue((btScalar)values[0], (btScalar)values[3], (btScalar)values[4],
+            (btScalar)values[3], (btScalar)values[1], (btScalar)values[5],
+            (btScalar)values[4], (btScalar)values[5], (btScalar)values[2]);
+}
+
+void computeSegmentedPointMassProperties(uint32_t count, const btScalar* x, const btScalar* y, const btScalar* z,
+        const btScalar* mass, const uint32_t* segment, uint32_t numSegments,
+        btScalar* totalMass, btScalar* centerOfMass, btScalar* inertia, uint32_t numThreads) {
+    // Bucket the points by body with a stable counting sort, so that each body is reduced once,
+    // by one thread, in point order whatever the number of threads.
+    std::vector<uint32_t> bodyStart(numSegments + 1, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        assert(segment[i] < numSegments);
+        ++bodyStart[segment[i] + 1];
+    }
+    for (uint32_t s = 0; s < numSegments; ++s) {
+        bodyStart[s + 1] += bodyStart[s];
+    }
+    std::vector<uint32_t> order(count);
+    std::vector<uint32_t> fill(bodyStart.begin(), bodyStart.end() - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        order[fill[segment[i]]++] = i;
+    }
+
+    // hand out about POINTS_PER_CHUNK points' worth of bodies at a time
+    uint32_t bodiesPerChunk = count > 0 ? (uint32_t)(((uint64_t)numSegments * POINTS_PER_CHUNK) / count) : numSegments;
+    parallelFor(numSegments, bodiesPerChunk, [&](uint32_t beginBody, uint32_t endBody) {
+        for (uint32_t s = beginBody; s < endBody; ++s) {
+            // each body is summed about its own first point, with runs of consecutive points
+            // summed together
+            PointMoments moments;
+            double pivot[3] = { 0.0, 0.0, 0.0 };
+            uint32_t begin = bodyStart[s];
+            uint32_t end = bodyStart[s + 1];
+            if (begin < end) {
+                pivot[0] = x[order[begin]];
+                pivot[1] = y[order[begin]];
+                pivot[2] = z[order[begin]];
+            }
+            uint32_t j = begin;
+            while (j < end) {
+                uint32_t runEnd = j + 1;
+                while (runEnd < end && order[runEnd] == order[runEnd - 1] + 1) {
+                    ++runEnd;
+                }
+                sumPointMoments(order[j], order[runEnd - 1] + 1, x, y, z, mass, pivot, moments);
+                j = runEnd;
+            }
+
+            double center[3];
+            double values[6];
+            moments.finish(pivot, center, values);
+            totalMass[s] = (btScalar)moments.mass;
+            for (uint32_t k = 0; k < 3; ++k) {
+                centerOfMass[3 * s + k] = (btScalar)center[k];
+            }
+            for (uint32_t k = 0; k < 6; ++k) {
+                inertia[6 * s + k] = (btScalar)values[k];
+            }
+        }
+    }, numThreads);
+}
@@ -0,0 +1,32 @@
+//
+//  PointMassProperties.h
+//
+// Mass properties of clouds of weighted points, e.g. particle and granular bodies.
+
+#ifndef POINT_MASS_PROPERTIES_H
+#define POINT_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+// Computes the total mass, center of mass and inertia about the center of mass of count point
+// masses given as parallel arrays (point i is <x[i], y[i], z[i]> with mass[i]).  One pass
+// accumulates the mass, first moment and second moment in double about the first point,
+// which keeps the final shift to the center of mass free of cancellation when the cloud is
+// far from the origin.  The points are split over numThreads threads (0 = one per hardware
+// core); the per-thread sums are combined in a fixed order so the result does not depend on
+// the number of threads.
+void computePointMassProperties(uint32_t count, const btScalar* x, const btScalar* y, const btScalar* z,
+        const btScalar* mass, btScalar& totalMass, btVector3& centerOfMass, btMatrix3x3& inertia,
+        uint32_t numThreads = 0);
+
+// Same for many bodies at once: point i belongs to body segment[i] < numSegments.  The points
+// of a body need not be contiguous.  Results are written per body to parallel arrays:
+// totalMass[b], centerOfMass[3 * b + k] and inertia[6 * b + k] (xx, yy, zz, xy, xz, yz).
+// A body with no points gets zero mass and inertia.  The points are bucketed by body and each
+// body is summed by a single thread, so the bodies rather than the points are spread over the
+// threads; for a few very large bodies call computePointMassProperties() on each instead.
+void computeSegmentedPointMassProperties(uint32_t count, const btScalar* x, const btScalar* y, const btScalar* z,
+        const btScalar* mass, const uint32_t* segment, uint32_t numSegments,
+        btScalar* totalMass, btScalar* centerOfMass, btScalar* inertia, uint32_t numThreads = 0);
+
+#endif // POINT_MASS_PROPERTIES_H
@@ -0,0 +1,201 @@
+//
+// PrimitiveMassProperties.cpp
+//
+// Closed-form volume, center of mass, and inertia of the primitive collision shapes.
+//
+
+#include "PrimitiveMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+// The batched loops below are branch free straight-line arithmetic over parallel arrays so
+// the compiler can vectorize them.  The single-shape functions go through the same helpers.
+
+// helper function
+inline void boxMoments(btScalar x, btScalar y, btScalar z,
+        btScalar& volume, btScalar& inertiaX, btScalar& inertiaY, btScalar& inertiaZ) {
+    // x, y, z are half extents: I = (V / 3) * (b^2 + c^2)
+    volume = 8.0f * x * y * z;
+    btScalar third = volume / 3.0f;
+    inertiaX = third * (y * y + z * z);
+    inertiaY = third * (z * z + x * x);
+    inertiaZ = third * (x * x + y * y);
+}
+
+// helper function
+inline void sphereMoments(btScalar radius,
+        btScalar& volume, btScalar& inertiaX, btScalar& inertiaY, btScalar& inertiaZ) {
+    // I = (2/5) * V * r^2
+    volume = (4.0f / 3.0f) * SIMD_PI * radius * radius * radius;
+    btScalar inertia = 0.4f * volume * radius * radius;
+    inertiaX = inertia;
+    inertiaY = inertia;
+    inertiaZ = inertia;
+}
+
+// helper function
+inline void capsuleMoments(btScalar radius, btScalar height,
+        btScalar& volume, btScalar& inertiaX, btScalar& inertiaY, btScalar& inertiaZ) {
+    // A cylinder plus two hemispheres.  Each hemisphere has its center of mass 3r/8 from its
+    // flat face, so about the capsule's center the two of them together contribute
+    //
+    //     axial:      (2/5) * Vs * r^2
+    //     transverse: Vs * ((2/5) * r^2 + H^2 / 4 + 3 * H * r / 8)
+    //
+    // where Vs is the volume of the whole sphere.
+    btScalar r2 = radius * radius;
+    btScalar cylinderVolume = SIMD_PI * r2 * height;
+    btScalar sphereVolume = (4.0f / 3.0f) * SIMD_PI * r2 * radius;
+    volume = cylinderVolume + sphereVolume;
+    inertiaY = 0.5f * cylinderVolume * r2 + 0.4f * sphereVolume * r2;
+    btScalar transverse = cylinderVolume * (3.0f * r2 + height * height) / 12.0f
+        + sphereVolume * (0.4f * r2 + 0.25f * height * height + 0.375f * height * radius);
+    inertiaX = transverse;
+    inertiaZ = transverse;
+}
+
+// helper function
+inline void cylinderMoments(btScalar radius, btScalar height,
+        btScalar& volume, btScalar& inertiaX, btScalar& inertiaY, btScalar& inertiaZ) {
+    // axial: V * r^2 / 2, transverse: V * (3 * r^2 + h^2) / 12
+    btScalar r2 = radius * radius;
+    volume = SIMD_PI * r2 * height;
+    inertiaY = 0.5f * volume * r2;
+    btScalar transverse = volume * (3.0f * r2 + height * height) / 12.0f;
+    inertiaX = transverse;
+    inertiaZ = transverse;
+}
+
+// helper function
+inline void coneMoments(btScalar radius, btScalar height,
+        btScalar& volume, btScalar& inertiaX, btScalar& inertiaY, btScalar& inertiaZ) {
+    // axial: (3/10) * V * r^2, transverse about the center of mass: V * (3 * r^2 / 20 + 3 * h^2 / 80)
+    btScalar r2 = radius * radius;
+    volume = SIMD_PI * r2 * height / 3.0f;
+    inertiaY = 0.3f * volume * r2;
+    btScalar transverse = volume * (0.15f * r2 + 0.0375f * height * height);
+    inertiaX = transverse;
+    inertiaZ = transverse;
+}
+
+// helper function
+void setDiagonalResult(btScalar volume, btScalar inertiaX, btScalar inertiaY, btScalar inertiaZ,
+        MeshMassProperties& result) {
+    result.m_volume = volume;
+    result.m_mass = volume;
+    result.m_centerOfMass.setZero();
+    result.m_inertia.setValue(inertiaX, 0.0f, 0.0f, 0.0f, inertiaY, 0.0f, 0.0f, 0.0f, inertiaZ);
+}
+
+void computeBoxMassProperties(const btVector3& halfExtents, MeshMassProperties& result) {
+    btScalar volume, inertiaX, inertiaY, inertiaZ;
+    boxMoments(halfExtents[0], halfExtents[1], halfExtents[2], volume, inertiaX, inertiaY, inertiaZ);
+    setDiagonalResult(volume, inertiaX, inertiaY, inertiaZ, result);
+}
+
+void computeSphereMassProperties(btScalar radius, MeshMassProperties& result) {
+    btScalar volume, inertiaX, inertiaY, inertiaZ;
+    sphereMoments(radius, volume, inertiaX, inertiaY, inertiaZ);
+    setDiagonalResult(volume, inertiaX, inertiaY, inertiaZ, result);
+}
+
+void computeEllipsoidMassProperties(const btVector3& semiAxes, MeshMassProperties& result) {
+    // I = (V / 5) * (b^2 + c^2)
+    btScalar a2 = semiAxes[0] * semiAxes[0];
+    btScalar b2 = semiAxes[1] * semiAxes[1];
+    btScalar c2 = semiAxes[2] * semiAxes[2];
+    btScalar volume = (4.0f / 3.0f) * SIMD_PI * semiAxes[0] * semiAxes[1] * semiAxes[2];
+    btScalar fifth = 0.2f * volume;
+    setDiagonalResult(volume, fifth * (b2 + c2), fifth * (c2 + a2), fifth * (a2 + b2), result);
+}
+
+void computeCapsuleMassProperties(btScalar radius, btScalar height, MeshMassProperties& result) {
+    btScalar volume, inertiaX, inertiaY, inertiaZ;
+    capsuleMoments(radius, height, volume, inertiaX, inertiaY, inertiaZ);
+    setDiagonalResult(volume, inertiaX, inertiaY, inertiaZ, result);
+}
+
+void computeCylinderMassProperties(btScalar radius, btScalar height, MeshMassProperties& result) {
+    btScalar volume, inertiaX, inertiaY, inertiaZ;
+    cylinderMoments(radius, height, volume, inertiaX, inertiaY, inertiaZ);
+    setDiagonalResult(volume, inertiaX, inertiaY, inertiaZ, result);
+}
+
+void computeConeMassProperties(btScalar radius, btScalar height, MeshMassProperties& result) {
+    btScalar volume, inertiaX, inertiaY, inertiaZ;
+    coneMoments(radius, height, volume, inertiaX, inertiaY, inertiaZ);
+    setDiagonalResult(volume, inertiaX, inertiaY, inertiaZ, result);
+    result.m_centerOfMass.setValue(0.0f, -0.25f * height, 0.0f);
+}
+
+void computeConvexPolyhedronMassProperties(const VectorOfPoints& points, const VectorOfIndices& faceSizes,
+        const VectorOfIndices& faceIndices, MeshMassProperties& result) {
+    uint32_t numPoints = points.size();
+    btVector3 centroid(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < numPoints; ++i) {
+        centroid += points[i];
+    }
+    if (numPoints > 0) {
+        centroid /= (btScalar)numPoints;
+    }
+
+    MassPropertiesAccumulator totals;
+    uint32_t numFaces = faceSizes.size();
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < numFaces; ++i) {
+        uint32_t size = faceSizes[i];
+        assert(first + size <= faceIndices.size());
+        const uint32_t* face = &faceIndices[first];
+        first += size;
+        if (size > 2) {
+            assert(face[0] < numPoints);
+            assert(face[1] < numPoints);
+            btVector3 p0 = points[face[0]] - centroid;
+            btVector3 previous = points[face[1]] - centroid;
+            for (uint32_t j = 2; j < size; ++j) {
+                assert(face[j] < numPoints);
+                btVector3 next = points[face[j]] - centroid;
+                totals.addTriangle(p0, previous, next);
+                previous = next;
+            }
+        }
+    }
+    totals.getMassProperties(result);
+    result.m_centerOfMass += centroid;
+}
+
+void computeBoxMassPropertiesBatch(uint32_t count, const btScalar* halfX, const btScalar* halfY, const btScalar* halfZ,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ) {
+    for (uint32_t i = 0; i < count; ++i) {
+        boxMoments(halfX[i], halfY[i], halfZ[i], volume[i], inertiaX[i], inertiaY[i], inertiaZ[i]);
+    }
+}
+
+void computeSphereMassPropertiesBatch(uint32_t count, const btScalar* radius,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ) {
+    for (uint32_t i = 0; i < count; ++i) {
+        sphereMoments(radius[i], volume[i], inertiaX[i], inertiaY[i], inertiaZ[i]);
+    }
+}
+
+void computeCapsuleMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ) {
+    for (uint32_t i = 0; i < count; ++i) {
+        capsuleMoments(radius[i], height[i], volume[i], inertiaX[i], inertiaY[i], inertiaZ[i]);
+    }
+}
+
+void computeCylinderMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ) {
+    for (uint32_t i = 0; i < count; ++i) {
+        cylinderMoments(radius[i], height[i], volume[i], inertiaX[i], inertiaY[i], inertiaZ[i]);
+    }
+}
+
+void computeConeMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ) {
+    for (uint32_t i = 0; i < count; ++i) {
+        coneMoments(radius[i], height[i], volume[i], inertiaX[i], inertiaY[i], inertiaZ[i]);
+    }
+}
@@ -0,0 +1,59 @@
+//
+//  PrimitiveMassProperties.h
+//
+// Closed-form volume, center of mass, and inertia of the primitive collision shapes.
+
+#ifndef PRIMITIVE_MASS_PROPERTIES_H
+#define PRIMITIVE_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+// Each shape is described in its own local frame using the same conventions as the matching
+// Bullet shape, so the results line up with btBoxShape, btSphereShape, btCapsuleShape,
+// btCylinderShape and btConeShape: the round shapes have their axis along local Y and are
+// centered on the origin.  As with meshes the density is one, so the volume doubles as the
+// mass.  To put a primitive into a compound, move it into the compound frame with
+// transformMassProperties() and hand it to MassPropertiesAccumulator::addMassProperties().
+
+void computeBoxMassProperties(const btVector3& halfExtents, MeshMassProperties& result);
+
+void computeSphereMassProperties(btScalar radius, MeshMassProperties& result);
+
+void computeEllipsoidMassProperties(const btVector3& semiAxes, MeshMassProperties& result);
+
+// height = length of the cylindrical section between the centers of the two hemispheres
+void computeCapsuleMassProperties(btScalar radius, btScalar height, MeshMassProperties& result);
+
+void computeCylinderMassProperties(btScalar radius, btScalar height, MeshMassProperties& result);
+
+// The cone's apex is at +height/2 and its base at -height/2, so its center of mass sits a
+// quarter of the height below the origin.
+void computeConeMassProperties(btScalar radius, btScalar height, MeshMassProperties& result);
+
+// Convex polyhedron given as right-hand wound planar faces (see
+// MeshMassProperties::computeMassPropertiesOfPolygons()).  Integration is about the centroid
+// of the points rather than the origin, so every tetrahedron is positive and accuracy does
+// not suffer when the shape is far from the origin.
+void computeConvexPolyhedronMassProperties(const VectorOfPoints& points, const VectorOfIndices& faceSizes,
+        const VectorOfIndices& faceIndices, MeshMassProperties& result);
+
+// Batched variants for many shapes of one kind.  Inputs and outputs are parallel arrays of
+// length count (element i describes shape i).  The inertia of every primitive is diagonal in
+// its local frame, so only the principal moments about the center of mass are written.  The
+// center of mass is the origin except for the cone (see above).
+void computeBoxMassPropertiesBatch(uint32_t count, const btScalar* halfX, const btScalar* halfY, const btScalar* halfZ,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ);
+
+void computeSphereMassPropertiesBatch(uint32_t count, const btScalar* radius,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ);
+
+void computeCapsuleMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ);
+
+void computeCylinderMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ);
+
+void computeConeMassPropertiesBatch(uint32_t count, const btScalar* radius, const btScalar* height,
+        btScalar* volume, btScalar* inertiaX, btScalar* inertiaY, btScalar* inertiaZ);
+
+#endif // PRIMITIVE_MASS_PROPERTIES_H
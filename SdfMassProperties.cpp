@@ -0,0 +1,141 @@
+//
+// SdfMassProperties.cpp
+//
+// Mass properties of a solid stored as a sparse grid of signed distance bricks.
+//
+
+#include "SdfMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "ParallelFor.h"
+
+// bricks integrated by one thread at a time
+const uint32_t BRICKS_PER_CHUNK = 64;
+
+// Volume, first moment and second moment (integral of x x^T) about the grid origin, in double
+// so that millions of small contributions do not wash out.
+struct SdfMoments {
+    double volume = 0.0;
+    double first[3] = { 0.0, 0.0, 0.0 };
+    double second[3][3] = { { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 } };
+
+    // Adds a solid box of the given volume, center and side lengths.  This is the box inertia
+    // formula moved by the parallel axis theorem, written in terms of the second moment:
+    // volume * (center center^T + diag(side^2) / 12).
+    void addBox(double boxVolume, const double* center, const double* side) {
+        volume += boxVolume;
+        for (uint32_t i = 0; i < 3; ++i) {
+            first[i] += boxVolume * center[i];
+            for (uint32_t j = 0; j < 3; ++j) {
+                second[i][j] += boxVolume * center[i] * center[j];
+            }
+            second[i][i] += boxVolume * side[i] * side[i] / 12.0;
+        }
+    }
+
+    void add(const SdfMoments& other) {
+        volume += other.volume;
+        for (uint32_t i = 0; i < 3; ++i) {
+            first[i] += other.first[i];
+            for (uint32_t j = 0; j < 3; ++j) {
+                second[i][j] += other.second[i][j];
+            }
+        }
+    }
+};
+
+// helper function
+void integrateSdfBrick(const SdfBrick& brick, double voxelSize, SdfMoments& moments) {
+    // Partially filled voxels are treated as full voxels scaled by their fill fraction.
+    double voxelVolume = voxelSize * voxelSize * voxelSize;
+    double side[3] = { voxelSize, voxelSize, voxelSize };
+    double inverseVoxelSize = 1.0 / voxelSize;
+    double corner[3] = {
+        (double)brick.m_x * SDF_BRICK_SIZE * voxelSize,
+        (double)brick.m_y * SDF_BRICK_SIZE * voxelSize,
+        (double)brick.m_z * SDF_BRICK_SIZE * voxelSize };
+    const float* distance = brick.m_distances;
+    for (uint32_t z = 0; z < SDF_BRICK_SIZE; ++z) {
+        for (uint32_t y = 0; y < SDF_BRICK_SIZE; ++y) {
+            for (uint32_t x = 0; x < SDF_BRICK_SIZE; ++x, ++distance) {
+                double fraction = 0.5 - (double)(*distance) * inverseVoxelSize;
+                if (fraction <= 0.0) {
+                    continue;
+                }
+                if (fraction > 1.0) {
+                    fraction = 1.0;
+                }
+                double center[3] = {
+                    corner[0] + (x + 0.5) * voxelSize,
+                    corner[1] + (y + 0.5) * voxelSize,
+                    corner[2] + (z + 0.5) * voxelSize };
+                moments.addBox(fraction * voxelVolume, center, side);
+            }
+        }
+    }
+}
+
+void computeSdfMassProperties(const SparseSdfGrid& grid, MeshMassProperties& result, uint32_t numThreads) {
+    double voxelSize = grid.m_voxelSize;
+    double tileSize = SDF_BRICK_SIZE * voxelSize;
+
+    // boundary bricks, each chunk into its own totals which are then summed in order
+    uint32_t numBricks = grid.m_bricks.size();
+    uint32_t numChunks = (numBricks + BRICKS_PER_CHUNK - 1) / BRICKS_PER_CHUNK;
+    std::vector<SdfMoments> chunkMoments(numChunks);
+    parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+        for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+            uint32_t begin = chunk * BRICKS_PER_CHUNK;
+            uint32_t end = (numBricks - begin > BRICKS_PER_CHUNK) ? begin + BRICKS_PER_CHUNK : numBricks;
+            for (uint32_t b = begin; b < end; ++b) {
+                integrateSdfBrick(grid.m_bricks[b], voxelSize, chunkMoments[chunk]);
+            }
+        }
+    }, numThreads);
+    SdfMoments moments;
+    for (const SdfMoments& chunk : chunkMoments) {
+        moments.add(chunk);
+    }
+
+    // interior tiles in closed form
+    assert(grid.m_interiorTiles.size() % 3 == 0);
+    double tileVolume = tileSize * tileSize * tileSize;
+    double side[3] = { tileSize, tileSize, tileSize };
+    uint32_t numTiles = grid.m_interiorTiles.size() / 3;
+    for (uint32_t t = 0; t < numTiles; ++t) {
+        const int32_t* tile = &grid.m_interiorTiles[3 * t];
+        double center[3] = { (tile[0] + 0.5) * tileSize, (tile[1] + 0.5) * tileSize, (tile[2] + 0.5) * tileSize };
+        moments.addBox(tileVolume, center, side);
+    }
+
+    if (moments.volume <= 0.0) {
+        result.m_volume = 0.0f;
+        result.m_mass = 0.0f;
+        result.m_centerOfMass = grid.m_origin;
+        result.m_inertia.setValue(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    // move the second moment to the center of mass, then inertia = trace(C) * E - C
+    double center[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        center[i] = moments.first[i] / moments.volume;
+    }
+    double secondMoment[3][3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            secondMoment[i][j] = moments.second[i][j] - moments.volume * center[i] * center[j];
+        }
+    }
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+    result.m_volume = (btScalar)moments.volume;
+    result.m_mass = result.m_volume;
+    for (uint32_t i = 0; i < 3; ++i) {
+        result.m_centerOfMass[i] = grid.m_origin[i] + (btScalar)center[i];
+        for (uint32_t j = 0; j < 3; ++j) {
+            result.m_inertia[i][j] = (btScalar)((i == j ? trace : 0.0) - secondMoment[i][j]);
+        }
+    }
+}
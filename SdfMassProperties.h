@@ -0,0 +1,43 @@
+//
+//  SdfMassProperties.h
+//
+// Mass properties of a solid stored as a sparse grid of signed distance bricks.
+
+#ifndef SDF_MASS_PROPERTIES_H
+#define SDF_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+// voxels along each side of a brick
+const uint32_t SDF_BRICK_SIZE = 8;
+const uint32_t SDF_VOXELS_PER_BRICK = SDF_BRICK_SIZE * SDF_BRICK_SIZE * SDF_BRICK_SIZE;
+
+// An allocated brick of the narrow band.  m_distances holds the signed distance (negative
+// inside) at the center of each voxel, x fastest then y then z.
+struct SdfBrick {
+    int32_t m_x, m_y, m_z;      // position in bricks
+    float m_distances[SDF_VOXELS_PER_BRICK];
+};
+
+// Sparse block grid: brick (i, j, k) covers the cube of side SDF_BRICK_SIZE * m_voxelSize
+// whose minimum corner is m_origin + SDF_BRICK_SIZE * m_voxelSize * <i, j, k>.  Only the
+// bricks near the surface store distances; bricks entirely inside the solid are listed as
+// interior tiles, and everything else is outside.
+struct SparseSdfGrid {
+    btScalar m_voxelSize = 1.0f;
+    btVector3 m_origin = btVector3(0.0f, 0.0f, 0.0f);
+    std::vector<SdfBrick> m_bricks;
+    std::vector<int32_t> m_interiorTiles;   // x, y, z (in bricks) per solid tile
+};
+
+// Computes the mass properties of the solid.  Interior tiles are added as solid boxes in closed
+// form.  Each voxel of a boundary brick is counted with the fraction clamp(1/2 - d / h, 0, 1)
+// of its volume, where d is its distance and h the voxel size.  That fraction is the exact cut
+// volume only for planes aligned with the grid axes; a tilted plane cuts a different volume,
+// and the mass of every voxel is placed at its center, ignoring the shift of the centroid of
+// its cut part.  Both errors are confined to the voxels the surface passes through.  Memory
+// and time scale with the number of allocated bricks rather than the bounding volume.  Bricks
+// are spread over numThreads threads (0 = one per hardware core).
+void computeSdfMassProperties(const SparseSdfGrid& grid, MeshMassProperties& result, uint32_t numThreads = 0);
+
+#endif // SDF_MASS_PROPERTIES_H
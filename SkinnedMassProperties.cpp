@@ -0,0 +1,73 @@
+//
+// SkinnedMassProperties.cpp
+//
+// Mass properties of a linear-blend skinned mesh in its current pose.
+//
+
+#include "SkinnedMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "ParallelFor.h"
+
+// triangles integrated by one thread at a time
+const uint32_t TRIANGLES_PER_CHUNK = 2048;
+
+// helper function
+inline btVector3 skinPoint(const SkinnedMesh& mesh, const std::vector<btTransform>& bonePalette, uint32_t point) {
+    // linear blend: sum over the influences of weight * (bone transform * rest point)
+    const btVector3& rest = mesh.m_restPoints[point];
+    const uint16_t* bones = &mesh.m_boneIndices[BONES_PER_POINT * point];
+    const btScalar* weights = &mesh.m_boneWeights[BONES_PER_POINT * point];
+    btVector3 skinned(0.0f, 0.0f, 0.0f);
+    for (uint32_t k = 0; k < BONES_PER_POINT; ++k) {
+        assert(bones[k] < bonePalette.size());
+        skinned += weights[k] * bonePalette[bones[k]](rest);
+    }
+    return skinned;
+}
+
+// helper function
+void accumulateSkinnedTriangles(const SkinnedMesh& mesh, const std::vector<btTransform>& bonePalette,
+        uint32_t begin, uint32_t end, MassPropertiesAccumulator& totals) {
+    uint32_t numPoints = mesh.m_restPoints.size();
+    const VectorOfIndices& triangleIndices = mesh.m_triangleIndices;
+    for (uint32_t i = begin; i < end; ++i) {
+        uint32_t t = 3 * i;
+        assert(triangleIndices[t] < numPoints);
+        assert(triangleIndices[t + 1] < numPoints);
+        assert(triangleIndices[t + 2] < numPoints);
+        totals.addTriangle(skinPoint(mesh, bonePalette, triangleIndices[t]),
+                skinPoint(mesh, bonePalette, triangleIndices[t + 1]),
+                skinPoint(mesh, bonePalette, triangleIndices[t + 2]));
+    }
+}
+
+void computeSkinnedMassProperties(const SkinnedMesh& mesh, const std::vector<btTransform>& bonePalette,
+        MeshMassProperties& result, uint32_t numThreads) {
+    assert(mesh.m_boneIndices.size() >= BONES_PER_POINT * mesh.m_restPoints.size());
+    assert(mesh.m_boneWeights.size() >= BONES_PER_POINT * mesh.m_restPoints.size());
+    uint32_t numTriangles = mesh.m_triangleIndices.size() / 3;
+    uint32_t numChunks = (numTriangles + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+
+    MassPropertiesAccumulator totals;
+    if (numThreads == 1 || numChunks <= 1) {
+        accumulateSkinnedTriangles(mesh, bonePalette, 0, numTriangles, totals);
+    } else {
+        // each chunk has its own totals, summed in order afterwards so the result does not
+        // depend on the number of threads
+        std::vector<MassPropertiesAccumulator> chunkTotals(numChunks);
+        parallelFor(numChunks, 1, [&](uint32_t beginChunk, uint32_t endChunk) {
+            for (uint32_t chunk = beginChunk; chunk < endChunk; ++chunk) {
+                uint32_t begin = chunk * TRIANGLES_PER_CHUNK;
+                uint32_t end = (numTriangles - begin > TRIANGLES_PER_CHUNK) ? begin + TRIANGLES_PER_CHUNK : numTriangles;
+                accumulateSkinnedTriangles(mesh, bonePalette, begin, end, chunkTotals[chunk]);
+            }
+        }, numThreads);
+        for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+            totals.addTotals(chunkTotals[chunk]);
+        }
+    }
+    totals.getMassProperties(result);
+}
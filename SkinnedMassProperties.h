@@ -0,0 +1,33 @@
+//
+//  SkinnedMassProperties.h
+//
+// Mass properties of a linear-blend skinned mesh in its current pose.
+
+#ifndef SKINNED_MASS_PROPERTIES_H
+#define SKINNED_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+const uint32_t BONES_PER_POINT = 4;
+
+// A closed mesh in its rest pose together with the bone influences of each point.  Point i is
+// skinned by bones m_boneIndices[4 * i + k] with weights m_boneWeights[4 * i + k], k = 0..3.
+// Unused influences should have zero weight; the weights of a point are expected to sum to one.
+struct SkinnedMesh {
+    VectorOfPoints m_restPoints;
+    std::vector<uint16_t> m_boneIndices;
+    std::vector<btScalar> m_boneWeights;
+    VectorOfIndices m_triangleIndices;
+};
+
+// Computes the mass properties of the mesh posed by the bone palette (bone-space to model-space
+// transforms, i.e. pose * inverse bind pose).  The points are skinned on the fly as each
+// triangle is integrated, so no posed copy of the mesh is ever written.  Points are shared by
+// several triangles and so are skinned more than once; that arithmetic is cheaper than the
+// memory traffic of a posed buffer.  numThreads = 0 (the default) splits each mesh across all
+// cores; for many characters per frame it is better to pass numThreads = 1 and run the
+// characters themselves in parallel.
+void computeSkinnedMassProperties(const SkinnedMesh& mesh, const std::vector<btTransform>& bonePalette,
+        MeshMassProperties& result, uint32_t numThreads = 0);
+
+#endif // SKINNED_MASS_PROPERTIES_H
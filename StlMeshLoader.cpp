@@ -0,0 +1,112 @@
+//
+// StlMeshLoader.cpp
+//
+// Reads STL files (binary or ASCII) as triangle soups.
+//
+
+#include "StlMeshLoader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+// Binary STL layout: 80 byte header, uint32 facet count, then 50 bytes per facet:
+// normal (3 float), three vertices (3 float each), uint16 attribute.
+const size_t STL_HEADER_SIZE = 84;
+const size_t STL_FACET_SIZE = 50;
+
+// helper function
+float readLittleEndianFloat(const unsigned char* bytes) {
+    uint32_t bits = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+}
+
+// helper function
+bool parseAsciiStl(std::vector<char>& contents, VectorOfPoints& soup, std::string& error) {
+    // only "vertex x y z" lines matter; facets are implied by every three vertices.  The keyword
+    // must be the first word of its line, so names and comments that contain it are skipped.
+    contents.push_back('\0');
+    const char* text = contents.data();
+    const char* keyword = "vertex";
+    const size_t keywordLength = 6;
+    const char* spaces = " \t\r\n";
+    size_t numVertices = 0;
+    while (*text) {
+        text += strspn(text, spaces);
+        size_t wordLength = strcspn(text, spaces);
+        if (wordLength == keywordLength && strncmp(text, keyword, keywordLength) == 0) {
+            char* cursor = (char*)text + keywordLength;
+            btScalar coords[3];
+            for (int i = 0; i < 3; ++i) {
+                char* next = cursor;
+                coords[i] = (btScalar)strtod(cursor, &next);
+                if (next == cursor) {
+                    error = "malformed vertex in ASCII STL";
+                    return false;
+                }
+                cursor = next;
+            }
+            soup.push_back(btVector3(coords[0], coords[1], coords[2]));
+            ++numVertices;
+            text = cursor;
+        }
+        // skip the rest of the line
+        text += strcspn(text, "\n");
+    }
+    if (numVertices % 3 != 0) {
+        error = "ASCII STL vertex count is not a multiple of three";
+        return false;
+    }
+    return true;
+}
+
+bool loadStlTriangleSoup(const std::string& path, VectorOfPoints& soup, std::string& error) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open file";
+        return false;
+    }
+    std::vector<char> contents;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        contents.resize(size);
+        if (fread(contents.data(), 1, size, file) != (size_t)size) {
+            fclose(file);
+            error = "cannot read file";
+            return false;
+        }
+    }
+    fclose(file);
+
+    // A binary file's size is fully determined by its facet count.  Checking that is more
+    // reliable than looking for "solid" since many binary exporters start their header with it.
+    if (contents.size() >= STL_HEADER_SIZE) {
+        const unsigned char* bytes = (const unsigned char*)contents.data();
+        uint32_t numFacets = (uint32_t)bytes[80] | ((uint32_t)bytes[81] << 8) | ((uint32_t)bytes[82] << 16) | ((uint32_t)bytes[83] << 24);
+        if (STL_HEADER_SIZE + (size_t)numFacets * STL_FACET_SIZE == contents.size()) {
+            soup.reserve(soup.size() + 3 * (size_t)numFacets);
+            const unsigned char* facet = bytes + STL_HEADER_SIZE;
+            for (uint32_t i = 0; i < numFacets; ++i) {
+                for (int j = 0; j < 3; ++j) {
+                    const unsigned char* vertex = facet + 12 * (j + 1);
+                    soup.push_back(btVector3(readLittleEndianFloat(vertex),
+                                readLittleEndianFloat(vertex + 4),
+                                readLittleEndianFloat(vertex + 8)));
+                }
+                facet += STL_FACET_SIZE;
+            }
+            return true;
+        }
+    }
+    if (contents.size() >= 5 && strncmp(contents.data(), "solid", 5) == 0) {
+        return parseAsciiStl(contents, soup, error);
+    }
+    error = "not an STL file";
+    return false;
+}
@@ -0,0 +1,18 @@
+//
+//  StlMeshLoader.h
+//
+// Reads STL files (binary or ASCII) as triangle soups.
+
+#ifndef STL_MESH_LOADER_H
+#define STL_MESH_LOADER_H
+
+#include <string>
+
+#include "MeshMassProperties.h"
+
+// Appends three points per facet to 'soup', in file order.  STL has no shared vertices so
+// the result is normally passed through weldTriangleSoup() before computing mass properties.
+// Returns false (with a reason in 'error') if the file cannot be read or parsed.
+bool loadStlTriangleSoup(const std::string& path, VectorOfPoints& soup, std::string& error);
+
+#endif // STL_MESH_LOADER_H
@@ -0,0 +1,144 @@
+//
+// TaskExecutor.cpp
+//
+// Interface through which the parallel computations and loaders hand out their work, plus
+// adapters for a built-in thread pool, OpenMP and a caller supplied parallel_for.
+//
+
+#include "TaskExecutor.h"
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif // _OPENMP
+
+std::atomic<TaskExecutor*> defaultTaskExecutor(nullptr);
+
+void setDefaultTaskExecutor(TaskExecutor* executor) {
+    defaultTaskExecutor = executor;
+}
+
+TaskExecutor* getDefaultTaskExecutor() {
+    return defaultTaskExecutor;
+}
+
+ThreadPoolExecutor::ThreadPoolExecutor(uint32_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::thread::hardware_concurrency();
+    }
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+    m_threads.reserve(numThreads - 1);
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        m_threads.push_back(std::thread(&ThreadPoolExecutor::workerLoop, this));
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPoolExecutor::parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) {
+    if (count == 0) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+    uint32_t numChunks = (count + grain - 1) / grain;
+    if (numChunks == 1 || m_threads.empty()) {
+        for (uint32_t chunk = 0; chunk < numChunks; ++chunk) {
+            uint32_t begin = chunk * grain;
+            body(begin, (count - begin > grain) ? begin + grain : count);
+        }
+        return;
+    }
+
+    Job job;
+    job.count = count;
+    job.grain = grain;
+    job.numChunks = numChunks;
+    job.body = &body;
+    job.nextChunk = 0;
+    job.numHelpers = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(&job);
+    }
+    m_wake.notify_all();
+
+    // the calling thread works too
+    runChunks(job);
+
+    // every chunk has been taken; the job lives on this stack so wait for the workers still
+    // running its chunks to let go of it
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.erase(std::find(m_jobs.begin(), m_jobs.end(), &job));
+    m_done.wait(lock, [&] { return job.numHelpers == 0; });
+}
+
+void ThreadPoolExecutor::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        Job* job = nullptr;
+        m_wake.wait(lock, [&] { return m_stop || (job = findJob()) != nullptr; });
+        if (m_stop) {
+            return;
+        }
+        ++job->numHelpers;
+        lock.unlock();
+        runChunks(*job);
+        lock.lock();
+        if (--job->numHelpers == 0) {
+            m_done.notify_all();
+        }
+    }
+}
+
+void ThreadPoolExecutor::runChunks(Job& job) {
+    uint32_t chunk;
+    while ((chunk = job.nextChunk++) < job.numChunks) {
+        uint32_t begin = chunk * job.grain;
+        uint32_t end = (job.count - begin > job.grain) ? begin + job.grain : job.count;
+        (*job.body)(begin, end);
+    }
+}
+
+ThreadPoolExecutor::Job* ThreadPoolExecutor::findJob() const {
+    // newest first, so nested loops complete before outer work is started
+    for (size_t i = m_jobs.size(); i > 0; --i) {
+        Job* job = m_jobs[i - 1];
+        if (job->nextChunk.load() < job->numChunks) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+#ifdef _OPENMP
+void OpenMpExecutor::parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) {
+    if (grain == 0) {
+        grain = 1;
+    }
+    int numChunks = (int)((count + grain - 1) / grain);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int chunk = 0; chunk < numChunks; ++chunk) {
+        uint32_t begin = (uint32_t)chunk * grain;
+        uint32_t end = (count - begin > grain) ? begin + grain : count;
+        body(begin, end);
+    }
+}
+
+uint32_t OpenMpExecutor::getConcurrency() const {
+    return (uint32_t)omp_get_max_threads();
+}
+#endif // _OPENMP
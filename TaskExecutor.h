@@ -0,0 +1,109 @@
+//
+//  TaskExecutor.h
+//
+// Interface through which the parallel computations and loaders hand out their work, plus
+// adapters for a built-in thread pool, OpenMP and a caller supplied parallel_for.
+
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+typedef std::function<void(uint32_t begin, uint32_t end)> RangeFunction;
+
+// An executor runs body(begin, end) over disjoint ranges that together cover [0, count) and
+// returns once all of them have completed.  'grain' is the preferred range length: ranges
+// should not be longer, and shorter ones are allowed.  The body must be safe to call
+// concurrently for different ranges.  An executor must tolerate parallelFor() being called
+// from inside a body (running the inner loop on the calling thread is fine).
+class TaskExecutor {
+public:
+    virtual ~TaskExecutor() {}
+    virtual void parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) = 0;
+
+    // number of ranges the executor expects to run at once, used to size work that is split
+    // by the caller (e.g. chunks of a file)
+    virtual uint32_t getConcurrency() const = 0;
+};
+
+// The executor used by every computation that takes a numThreads argument, unless that
+// argument is 1 (run on the calling thread).  While no executor is installed those calls
+// start numThreads threads of their own.  The executor is not owned and must outlive its use.
+void setDefaultTaskExecutor(TaskExecutor* executor);
+TaskExecutor* getDefaultTaskExecutor();
+
+// Persistent pool of worker threads.  Each call publishes its ranges to the pool; idle workers
+// and the calling thread take them one at a time until none are left.  Calls made from inside
+// a body, or from several threads at once, are published the same way and share the idle
+// workers.  Workers take from the most recent call first, so nested loops finish before more
+// outer work is started.
+class ThreadPoolExecutor : public TaskExecutor {
+public:
+    // numThreads counts the calling thread; 0 uses one per hardware core
+    ThreadPoolExecutor(uint32_t numThreads = 0);
+    ~ThreadPoolExecutor();
+
+    void parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) override;
+    uint32_t getConcurrency() const override { return m_threads.size() + 1; }
+
+private:
+    struct Job {
+        uint32_t count;
+        uint32_t grain;
+        uint32_t numChunks;
+        const RangeFunction* body;
+        std::atomic<uint32_t> nextChunk;
+        uint32_t numHelpers;    // workers running chunks of this job, guarded by m_mutex
+    };
+
+    void workerLoop();
+    void runChunks(Job& job);
+    Job* findJob() const;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::vector<Job*> m_jobs;   // calls in progress, oldest first
+    bool m_stop = false;
+};
+
+#ifdef _OPENMP
+// Hands the ranges to an OpenMP parallel loop with dynamic scheduling.
+class OpenMpExecutor : public TaskExecutor {
+public:
+    void parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) override;
+    uint32_t getConcurrency() const override;
+};
+#endif // _OPENMP
+
+// Forwards to a parallel_for supplied by the caller, typically a thin wrapper around an engine
+// job system.  The callback receives the arguments of TaskExecutor::parallelFor and has the
+// same obligations: cover [0, count) with disjoint ranges and return after all have run.
+typedef std::function<void(uint32_t count, uint32_t grain, const RangeFunction& body)> ParallelForCallback;
+
+class CallbackExecutor : public TaskExecutor {
+public:
+    CallbackExecutor(const ParallelForCallback& callback, uint32_t concurrency)
+        : m_callback(callback), m_concurrency(concurrency > 0 ? concurrency : 1) {}
+
+    void parallelFor(uint32_t count, uint32_t grain, const RangeFunction& body) override {
+        if (count > 0) {
+            m_callback(count, grain > 0 ? grain : 1, body);
+        }
+    }
+    uint32_t getConcurrency() const override { return m_concurrency; }
+
+private:
+    ParallelForCallback m_callback;
+    uint32_t m_concurrency;
+};
+
+#endif // TASK_EXECUTOR_H
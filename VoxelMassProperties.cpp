@@ -0,0 +1,185 @@
+//
+// VoxelMassProperties.cpp
+//
+// Mass properties of a solid described by a dense grid of occupied voxels.
+//
+
+#include "VoxelMassProperties.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "ParallelFor.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bit b of a word is set in INDEX_BIT_MASKS[m] when bit m of b is set.  The sum of the
+// positions of the set bits of a word w is then sum(2^m * popcount(w & INDEX_BIT_MASKS[m])),
+// and the sum of their squares follows the same way from pairs of masks.
+const uint64_t INDEX_BIT_MASKS[6] = {
+    0xaaaaaaaaaaaaaaaaULL,
+    0xccccccccccccccccULL,
+    0xf0f0f0f0f0f0f0f0ULL,
+    0xff00ff00ff00ff00ULL,
+    0xffff0000ffff0000ULL,
+    0xffffffff00000000ULL };
+
+// helper function
+inline int64_t popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int64_t)__popcnt64(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int64_t)((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Sums over the occupied voxels of a slab, in voxel index units.
+struct VoxelSums {
+    int64_t n = 0;
+    int64_t x = 0, y = 0, z = 0;
+    int64_t xx = 0, yy = 0, zz = 0;
+    int64_t xy = 0, xz = 0, yz = 0;
+};
+
+void VoxelGrid::resize(uint32_t numX, uint32_t numY, uint32_t numZ) {
+    m_numX = numX;
+    m_numY = numY;
+    m_numZ = numZ;
+    m_bits.assign((size_t)getWordsPerRow() * numY * numZ, 0);
+}
+
+// helper function
+void sumVoxelSlab(const VoxelGrid& grid, uint32_t z, VoxelSums& sums) {
+    uint32_t wordsPerRow = grid.getWordsPerRow();
+    // bits beyond m_numX in the last word of a row are ignored
+    uint64_t lastWordMask = (grid.m_numX % 64 == 0) ? ~(uint64_t)0 : (((uint64_t)1 << (grid.m_numX % 64)) - 1);
+    for (uint32_t y = 0; y < grid.m_numY; ++y) {
+        const uint64_t* row = grid.getRow(y, z);
+        int64_t n = 0;
+        int64_t sx = 0;
+        int64_t sxx = 0;
+        for (uint32_t w = 0; w < wordsPerRow; ++w) {
+            uint64_t word = row[w];
+            if (w + 1 == wordsPerRow) {
+                word &= lastWordMask;
+            }
+            if (word == 0) {
+                continue;
+            }
+            int64_t count = popcount64(word);
+            int64_t indexSum = 0;
+            int64_t indexSquaredSum = 0;
+            for (uint32_t m = 0; m < 6; ++m) {
+                uint64_t maskedWord = word & INDEX_BIT_MASKS[m];
+                indexSum += popcount64(maskedWord) << m;
+                indexSquaredSum += popcount64(maskedWord) << (2 * m);
+                for (uint32_t k = m + 1; k < 6; ++k) {
+                    indexSquaredSum += popcount64(maskedWord & INDEX_BIT_MASKS[k]) << (m + k + 1);
+                }
+            }
+            // shift from positions within the word to x: sum((b + i)^2) = b^2 n + 2 b sum(i) + sum(i^2)
+            int64_t base = 64 * (int64_t)w;
+            n += count;
+            sx += base * count + indexSum;
+            sxx += base * base * count + 2 * base * indexSum + indexSquaredSum;
+        }
+        if (n == 0) {
+            continue;
+        }
+        sums.n += n;
+        sums.x += sx;
+        sums.y += (int64_t)y * n;
+        sums.z += (int64_t)z * n;
+        sums.xx += sxx;
+        sums.yy += (int64_t)y * y * n;
+        sums.zz += (int64_t)z * z * n;
+        sums.xy += (int64_t)y * sx;
+        sums.xz += (int64_t)z * sx;
+        sums.yz += (int64_t)y * z * n;
+    }
+}
+
+// helper function
+bool voxelSumsFit(const VoxelGrid& grid) {
+    // every second-order sum is at most the voxel count times the largest index squared
+    double maxIndex = (double)std::max(grid.m_numX, std::max(grid.m_numY, grid.m_numZ));
+    double numVoxels = (double)grid.m_numX * (double)grid.m_numY * (double)grid.m_numZ;
+    return numVoxels * maxIndex * maxIndex < 9223372036854775808.0;
+}
+
+void computeVoxelMassProperties(const VoxelGrid& grid, MeshMassProperties& result, uint32_t numThreads) {
+    assert(grid.m_bits.size() >= (size_t)grid.getWordsPerRow() * grid.m_numY * grid.m_numZ);
+    assert(voxelSumsFit(grid));
+    std::vector<VoxelSums> slabSums(grid.m_numZ);
+    parallelFor(grid.m_numZ, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t z = begin; z < end; ++z) {
+            sumVoxelSlab(grid, z, slabSums[z]);
+        }
+    }, numThreads);
+
+    VoxelSums sums;
+    for (const VoxelSums& slab : slabSums) {
+        sums.n += slab.n;
+        sums.x += slab.x;
+        sums.y += slab.y;
+        sums.z += slab.z;
+        sums.xx += slab.xx;
+        sums.yy += slab.yy;
+        sums.zz += slab.zz;
+        sums.xy += slab.xy;
+        sums.xz += slab.xz;
+        sums.yz += slab.yz;
+    }
+    if (sums.n == 0) {
+        result.m_volume = 0.0f;
+        result.m_mass = 0.0f;
+        result.m_centerOfMass = grid.m_origin;
+        result.m_inertia.setValue(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    // Voxel centers sit at index + 1/2, so with u = x + 1/2:
+    //
+    //     sum(u) = sum(x) + n / 2      sum(u v) = sum(x y) + (sum(x) + sum(y)) / 2 + n / 4
+    //
+    // Each voxel also carries its own second moment of 1/12 per axis (in voxel units).
+    double n = (double)sums.n;
+    double first[3] = { (double)sums.x, (double)sums.y, (double)sums.z };
+    double second[3][3] = {
+        { (double)sums.xx, (double)sums.xy, (double)sums.xz },
+        { (double)sums.xy, (double)sums.yy, (double)sums.yz },
+        { (double)sums.xz, (double)sums.yz, (double)sums.zz } };
+    double center[3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        center[i] = (first[i] + 0.5 * n) / n;
+    }
+    double secondMoment[3][3];
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 3; ++j) {
+            double centered = second[i][j] + 0.5 * (first[i] + first[j]) + 0.25 * n;
+            secondMoment[i][j] = centered - n * center[i] * center[j] + (i == j ? n / 12.0 : 0.0);
+        }
+    }
+
+    // scale from voxel units: lengths by h, volumes by h^3
+    double h = grid.m_voxelSize;
+    double h5 = h * h * h * h * h;
+    double trace = secondMoment[0][0] + secondMoment[1][1] + secondMoment[2][2];
+    result.m_volume = (btScalar)(n * h * h * h);
+    result.m_mass = result.m_volume;
+    for (uint32_t i = 0; i < 3; ++i) {
+        result.m_centerOfMass[i] = grid.m_origin[i] + (btScalar)(h * center[i]);
+        for (uint32_t j = 0; j < 3; ++j) {
+            result.m_inertia[i][j] = (btScalar)(h5 * ((i == j ? trace : 0.0) - secondMoment[i][j]));
+        }
+    }
+}
@@ -0,0 +1,42 @@
+//
+//  VoxelMassProperties.h
+//
+// Mass properties of a solid described by a dense grid of occupied voxels.
+
+#ifndef VOXEL_MASS_PROPERTIES_H
+#define VOXEL_MASS_PROPERTIES_H
+
+#include "MeshMassProperties.h"
+
+// Dense occupancy grid with one bit per voxel.  Voxel (x, y, z) is the cube of side
+// m_voxelSize whose minimum corner is m_origin + m_voxelSize * <x, y, z>.  Each row of
+// voxels along x is packed into whole 64-bit words (bit x % 64 of word x / 64) and rows are
+// stored y-major within each z slab.
+struct VoxelGrid {
+    uint32_t m_numX = 0;
+    uint32_t m_numY = 0;
+    uint32_t m_numZ = 0;
+    btScalar m_voxelSize = 1.0f;
+    btVector3 m_origin = btVector3(0.0f, 0.0f, 0.0f);
+    std::vector<uint64_t> m_bits;
+
+    // allocate an empty grid
+    void resize(uint32_t numX, uint32_t numY, uint32_t numZ);
+
+    uint32_t getWordsPerRow() const { return (m_numX + 63) / 64; }
+    uint64_t* getRow(uint32_t y, uint32_t z) { return &m_bits[((size_t)z * m_numY + y) * getWordsPerRow()]; }
+    const uint64_t* getRow(uint32_t y, uint32_t z) const { return &m_bits[((size_t)z * m_numY + y) * getWordsPerRow()]; }
+
+    void set(uint32_t x, uint32_t y, uint32_t z) { getRow(y, z)[x / 64] |= (uint64_t)1 << (x % 64); }
+    bool get(uint32_t x, uint32_t y, uint32_t z) const { return (getRow(y, z)[x / 64] >> (x % 64)) & 1; }
+};
+
+// Computes the mass properties of the occupied voxels without extracting a surface.  Each
+// row is reduced to its count and sums of x and x^2 with popcounts; the rows of a slab are then
+// combined with their y and z in exact 64-bit integer arithmetic, so the only rounding happens
+// in the final conversion.  That needs numX * numY * numZ * max(numX, numY, numZ)^2 < 2^63,
+// about 6200 voxels a side for a cube, which is asserted.  Slabs are spread over numThreads
+// threads (0 = one per hardware core).
+void computeVoxelMassProperties(const VoxelGrid& grid, MeshMassProperties& result, uint32_t numThreads = 0);
+
+#endif // VOXEL_MASS_PROPERTIES_H
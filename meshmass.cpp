@@ -0,0 +1,404 @@
+//
+// meshmass.cpp
+//
+// Command line tool that computes the mass properties of every mesh file found under the given
+// paths and prints one JSON Lines or CSV record per mesh.
+//
+// usage: meshmass [options] <file or directory>...
+//
+//     --format jsonl|csv       output format (default jsonl)
+//     --threads N              number of worker threads (default: one per core)
+//     --max-inflight-mb N      bound on the size of files being processed at once (default 1024)
+//     --weld-tolerance T       welding tolerance for unindexed formats such as STL (default 0)
+//
+// Meshes that enclose no volume have no center of mass or inertia; their records carry status
+// "error" with null (JSON) or empty (CSV) fields in place of those values.  A file that reads
+// without error but holds no faces gets one record with status "error".
+//
+// Building needs C++17 (<filesystem>, std::from_chars) and Bullet's LinearMath headers, e.g.
+//
+//     c++ -std=c++17 -O2 -pthread -I<bullet>/src *.cpp -o meshmass
+//
+// with every .cpp of this directory except the unit tests (MeshMassPropertiesTests.cpp).
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GltfMeshLoader.h"
+#include "MeshMassProperties.h"
+#include "MeshWelding.h"
+#include "ObjMeshLoader.h"
+#include "ParallelFor.h"
+#include "PlyMeshLoader.h"
+#include "StlMeshLoader.h"
+
+struct Options {
+    bool csv = false;
+    uint32_t numThreads = 0;
+    uint64_t maxInFlightBytes = (uint64_t)1024 * 1024 * 1024;
+    btScalar weldTolerance = 0.0f;
+    std::vector<std::string> paths;
+};
+
+struct MeshResult {
+    std::string name;
+    uint32_t numTriangles = 0;
+    MeshMassProperties properties;
+    MeshTopologyReport topology;
+    bool hasTopology = false; // not every loader validates topology
+};
+
+struct FileResult {
+    std::string error;
+    std::vector<MeshResult> meshes;
+    double loadSeconds = 0.0;
+    double computeSeconds = 0.0;
+};
+
+// Workers block here before loading a file until its size fits in the budget.  A file larger
+// than the whole budget is admitted alone.
+class InFlightBudget {
+public:
+    InFlightBudget(uint64_t maxBytes) : m_maxBytes(maxBytes) {}
+
+    void acquire(uint64_t bytes) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [&] { return m_bytes == 0 || m_bytes + bytes <= m_maxBytes; });
+        m_bytes += bytes;
+    }
+
+    void release(uint64_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bytes -= bytes;
+        }
+        m_condition.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint64_t m_bytes = 0;
+    uint64_t m_maxBytes;
+};
+
+std::string lowercaseExtension(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+bool isSupportedFile(const std::filesystem::path& path) {
+    std::string extension = lowercaseExtension(path);
+    return extension == ".stl" || extension == ".obj" || extension == ".ply"
+        || extension == ".gltf" || extension == ".glb";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void computeMesh(const std::string& name, const VectorOfPoints& points, const VectorOfIndices& triangleIndices,
+        FileResult& result) {
+    MeshResult mesh;
+    mesh.name = name;
+    mesh.numTriangles = triangleIndices.size() / 3;
+    mesh.properties.computeMassProperties(points, triangleIndices, mesh.topology);
+    mesh.hasTopology = true;
+    result.meshes.push_back(mesh);
+}
+
+void processFile(const std::string& path, const Options& options, FileResult& result) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string extension = lowercaseExtension(path);
+    if (extension == ".stl") {
+        VectorOfPoints soup;
+        if (!loadStlTriangleSoup(path, soup, result.error)) {
+            return;
+        }
+        if (soup.empty()) {
+            result.error = "file contains no faces";
+            return;
+        }
+        VectorOfPoints points;
+        VectorOfIndices triangleIndices;
+        weldTriangleSoup(soup, options.weldTolerance, points, triangleIndices);
+        result.loadSeconds = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        computeMesh("", points, triangleIndices, result);
+        result.computeSeconds = secondsSince(start);
+    } else if (extension == ".obj") {
+        // files are already spread over the workers so parse each one on a single thread
+        std::vector<MeshGroup> groups;
+        if (!loadObjMeshGroups(path, groups, result.error, 1)) {
+            return;
+        }
+        result.loadSeconds = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (const MeshGroup& group : groups) {
+            computeMesh(group.name, group.points, group.triangleIndices, result);
+        }
+        result.computeSeconds = secondsSince(start);
+    } else if (extension == ".ply") {
+        // PLY is integrated while it is read so there is no separate load time
+        MeshResult mesh;
+        if (!computePlyMassProperties(path, mesh.properties, mesh.numTriangles, result.error)) {
+            return;
+        }
+        if (mesh.numTriangles == 0) {
+            result.error = "file contains no faces";
+            return;
+        }
+        result.computeSeconds = secondsSince(start);
+        result.meshes.push_back(mesh);
+    } else if (extension == ".gltf" || extension == ".glb") {
+        // also integrated while read; one record per mesh instance in the scene
+        std::vector<GltfMeshInstance> instances;
+        if (!computeGltfMassProperties(path, instances, result.error)) {
+            return;
+        }
+        result.computeSeconds = secondsSince(start);
+        for (const GltfMeshInstance& instance : instances) {
+            MeshResult mesh;
+            mesh.name = instance.name;
+            mesh.numTriangles = instance.numTriangles;
+            mesh.properties = instance.properties;
+            result.meshes.push_back(mesh);
+        }
+    } else {
+        result.error = "unsupported file type";
+    }
+    if (result.error.empty() && result.meshes.empty()) {
+        result.error = "file contains no faces";
+    }
+}
+
+// a mesh that encloses no volume has no center of mass, and its inertia is meaningless
+bool hasMassProperties(const MeshMassProperties& properties) {
+    if (!(properties.m_mass != 0.0f) || !std::isfinite(properties.m_mass)) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!std::isfinite(properties.m_centerOfMass[i])) {
+            return false;
+        }
+        for (int j = 0; j < 3; ++j) {
+            if (!std::isfinite(properties.m_inertia[i][j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const char* ZERO_VOLUME_ERROR = "mesh encloses no volume";
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)c);
+            escaped += buffer;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string escapeCsv(const std::string& text) {
+    std::string escaped = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+const char* CSV_HEADER = "path,mesh,status,triangles,volume,com_x,com_y,com_z,"
+    "inertia_xx,inertia_yy,inertia_zz,inertia_xy,inertia_xz,inertia_yz,"
+    "boundary_edges,non_manifold_edges,misoriented_edges,load_ms,compute_ms,error\n";
+
+std::string formatRecord(const std::string& path, const FileResult& file, const MeshResult* mesh, bool csv) {
+    char buffer[1024];
+    const char* status = mesh ? "ok" : "error";
+    std::string name = mesh ? mesh->name : "";
+    double loadMs = 1000.0 * file.loadSeconds;
+    double computeMs = 1000.0 * file.computeSeconds;
+    if (!mesh) {
+        if (csv) {
+            snprintf(buffer, sizeof(buffer), ",%s,,,,,,,,,,,,,,,%.3f,%.3f,", status, loadMs, computeMs);
+            return escapeCsv(path) + "," + escapeCsv(name) + buffer + escapeCsv(file.error) + "\n";
+        }
+        snprintf(buffer, sizeof(buffer), "\"status\":\"%s\",\"load_ms\":%.3f,\"compute_ms\":%.3f,", status, loadMs, computeMs);
+        return "{\"path\":\"" + escapeJson(path) + "\"," + buffer + "\"error\":\"" + escapeJson(file.error) + "\"}\n";
+    }
+
+    const MeshMassProperties& p = mesh->properties;
+    const MeshTopologyReport& t = mesh->topology;
+    bool valid = hasMassProperties(p);
+    if (!valid) {
+        status = "error";
+    }
+    double volume = std::isfinite(p.m_volume) ? (double)p.m_volume : 0.0;
+    if (csv) {
+        char topology[64] = ",,";
+        if (mesh->hasTopology) {
+            snprintf(topology, sizeof(topology), "%u,%u,%u",
+                t.m_numBoundaryEdges, t.m_numNonManifoldEdges, t.m_numMisorientedEdges);
+        }
+        char values[256] = ",,,,,,,,";
+        if (valid) {
+            snprintf(values, sizeof(values), "%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g",
+                (double)p.m_centerOfMass[0], (double)p.m_centerOfMass[1], (double)p.m_centerOfMass[2],
+                (double)p.m_inertia[0][0], (double)p.m_inertia[1][1], (double)p.m_inertia[2][2],
+                (double)p.m_inertia[0][1], (double)p.m_inertia[0][2], (double)p.m_inertia[1][2]);
+        }
+        snprintf(buffer, sizeof(buffer), ",%s,%u,%.9g,%s,%s,%.3f,%.3f,",
+            status, mesh->numTriangles, volume, values, topology, loadMs, computeMs);
+        return escapeCsv(path) + "," + escapeCsv(name) + buffer + (valid ? "" : escapeCsv(ZERO_VOLUME_ERROR)) + "\n";
+    }
+    char topology[128] = "\"boundary_edges\":null,\"non_manifold_edges\":null,\"misoriented_edges\":null";
+    if (mesh->hasTopology) {
+        snprintf(topology, sizeof(topology), "\"boundary_edges\":%u,\"non_manifold_edges\":%u,\"misoriented_edges\":%u",
+            t.m_numBoundaryEdges, t.m_numNonManifoldEdges, t.m_numMisorientedEdges);
+    }
+    char values[512] = "\"center_of_mass\":null,\"inertia\":null";
+    if (valid) {
+        snprintf(values, sizeof(values),
+            "\"center_of_mass\":[%.9g,%.9g,%.9g],\"inertia\":[[%.9g,%.9g,%.9g],[%.9g,%.9g,%.9g],[%.9g,%.9g,%.9g]]",
+            (double)p.m_centerOfMass[0], (double)p.m_centerOfMass[1], (double)p.m_centerOfMass[2],
+            (double)p.m_inertia[0][0], (double)p.m_inertia[0][1], (double)p.m_inertia[0][2],
+            (double)p.m_inertia[1][0], (double)p.m_inertia[1][1], (double)p.m_inertia[1][2],
+            (double)p.m_inertia[2][0], (double)p.m_inertia[2][1], (double)p.m_inertia[2][2]);
+    }
+    snprintf(buffer, sizeof(buffer), "\"status\":\"%s\",\"triangles\":%u,\"volume\":%.9g,%s,%s,\"load_ms\":%.3f,\"compute_ms\":%.3f",
+        status, mesh->numTriangles, volume, values, topology, loadMs, computeMs);
+    std::string record = "{\"path\":\"" + escapeJson(path) + "\",\"mesh\":\"" + escapeJson(name) + "\"," + buffer;
+    if (!valid) {
+        record += std::string(",\"error\":\"") + ZERO_VOLUME_ERROR + "\"";
+    }
+    return record + "}\n";
+}
+
+void printUsage() {
+    fprintf(stderr,
+        "usage: meshmass [options] <file or directory>...\n"
+        "    --format jsonl|csv       output format (default jsonl)\n"
+        "    --threads N              number of worker threads (default: one per core)\n"
+        "    --max-inflight-mb N      bound on the size of files being processed at once (default 1024)\n"
+        "    --weld-tolerance T       welding tolerance for unindexed formats such as STL (default 0)\n");
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            std::string format = argv[++i];
+            if (format != "jsonl" && format != "csv") {
+                return false;
+            }
+            options.csv = (format == "csv");
+        } else if (arg == "--threads" && hasValue) {
+            options.numThreads = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--max-inflight-mb" && hasValue) {
+            options.maxInFlightBytes = (uint64_t)atoll(argv[++i]) * 1024 * 1024;
+        } else if (arg == "--weld-tolerance" && hasValue) {
+            options.weldTolerance = (btScalar)atof(argv[++i]);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return false;
+        } else {
+            options.paths.push_back(arg);
+        }
+    }
+    return !options.paths.empty();
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // gather the files up front, sorted so that runs are reproducible
+    std::vector<std::string> files;
+    for (const std::string& path : options.paths) {
+        std::error_code error;
+        if (std::filesystem::is_directory(path, error)) {
+            std::filesystem::recursive_directory_iterator itr(path, std::filesystem::directory_options::skip_permission_denied, error);
+            for (; !error && itr != std::filesystem::recursive_directory_iterator(); itr.increment(error)) {
+                if (itr->is_regular_file(error) && isSupportedFile(itr->path())) {
+                    files.push_back(itr->path().string());
+                }
+            }
+        } else {
+            files.push_back(path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    if (options.csv) {
+        fputs(CSV_HEADER, stdout);
+    }
+
+    // Files are handed to the workers one at a time.  Records are printed as soon as a file
+    // finishes, so output order follows completion order rather than the sorted file list.
+    // One pool serves every parallel path so nothing starts threads of its own.  Work submitted
+    // from inside a file's worker is shared with whichever workers are idle.
+    ThreadPoolExecutor pool(options.numThreads);
+    setDefaultTaskExecutor(&pool);
+    InFlightBudget budget(options.maxInFlightBytes);
+    std::mutex outputMutex;
+    uint32_t numFailures = 0;
+    parallelFor(files.size(), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const std::string& path = files[i];
+            std::error_code error;
+            uint64_t size = std::filesystem::file_size(path, error);
+            if (error) {
+                size = 0;
+            }
+            budget.acquire(size);
+            FileResult result;
+            processFile(path, options, result);
+            budget.release(size);
+
+            std::string output;
+            bool failed = !result.error.empty();
+            if (failed) {
+                output = formatRecord(path, result, nullptr, options.csv);
+            }
+            for (const MeshResult& mesh : result.meshes) {
+                output += formatRecord(path, result, &mesh, options.csv);
+                failed = failed || !hasMassProperties(mesh.properties);
+            }
+            std::lock_guard<std::mutex> lock(outputMutex);
+            fputs(output.c_str(), stdout);
+            if (failed) {
+                ++numFailures;
+            }
+        }
+    }, pool);
+    setDefaultTaskExecutor(nullptr);
+
+    return numFailures > 0 ? 1 : 0;
+}